@@ -397,8 +397,8 @@ int main(void) {
 
     freecs_world_t world = freecs_create_world();
 
-    BIT_POSITION = FREECS_REGISTER(&world, Position);
-    BIT_VELOCITY = FREECS_REGISTER(&world, Velocity);
+    BIT_POSITION = FREECS_REGISTER_ALIGNED(&world, Position, 32);
+    BIT_VELOCITY = FREECS_REGISTER_ALIGNED(&world, Velocity, 32);
     BIT_BOID = FREECS_REGISTER(&world, Boid);
     BIT_COLOR = FREECS_REGISTER(&world, BoidColor);
 
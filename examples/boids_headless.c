@@ -0,0 +1,402 @@
+#include "../freecs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef struct { float x, y; } Position;
+typedef struct { float x, y; } Velocity;
+typedef struct { uint8_t _; } Boid;
+
+typedef struct {
+    float alignment_weight;
+    float cohesion_weight;
+    float separation_weight;
+    float visual_range;
+    float visual_range_sq;
+    float min_speed;
+    float max_speed;
+} BoidParams;
+
+typedef struct {
+    float x, y;
+    float vx, vy;
+} BoidData;
+
+typedef struct {
+    BoidData* boids;
+    BoidData* scratch;
+    uint32_t* cell_starts;
+    size_t capacity;
+    float cell_size;
+    float inv_cell;
+    int width;
+    int height;
+    int total;
+    int range_cells;
+} SpatialGrid;
+
+typedef struct {
+    SpatialGrid* grid;
+    BoidParams* params;
+    float dt;
+    float screen_w;
+    float screen_h;
+} TickContext;
+
+static freecs_mask_t BIT_POSITION;
+static freecs_mask_t BIT_VELOCITY;
+static freecs_mask_t BIT_BOID;
+
+static uint64_t rng_state = 0x2545f4914f6cdd1dULL;
+
+static float rand_float(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return (float)(rng_state >> 40) / (float)(1 << 24);
+}
+
+static float rand_range(float min, float max) {
+    return min + rand_float() * (max - min);
+}
+
+static double now_seconds(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+static SpatialGrid create_grid(float screen_width, float screen_height, float cell_size, float visual_range, size_t capacity) {
+    int width = (int)ceilf(screen_width / cell_size);
+    int height = (int)ceilf(screen_height / cell_size);
+    int total = width * height;
+
+    return (SpatialGrid){
+        .boids = malloc(capacity * sizeof(BoidData)),
+        .scratch = malloc(capacity * sizeof(BoidData)),
+        .cell_starts = malloc(((size_t)total + 1) * sizeof(uint32_t)),
+        .capacity = capacity,
+        .cell_size = cell_size,
+        .inv_cell = 1.0f / cell_size,
+        .width = width,
+        .height = height,
+        .total = total,
+        .range_cells = (int)ceilf(visual_range / cell_size)
+    };
+}
+
+static void destroy_grid(SpatialGrid* grid) {
+    free(grid->boids);
+    free(grid->scratch);
+    free(grid->cell_starts);
+}
+
+static inline int grid_cell(const SpatialGrid* grid, float x, float y) {
+    int cell_x = (int)(x * grid->inv_cell);
+    int cell_y = (int)(y * grid->inv_cell);
+    if (cell_x < 0) cell_x = 0;
+    if (cell_x >= grid->width) cell_x = grid->width - 1;
+    if (cell_y < 0) cell_y = 0;
+    if (cell_y >= grid->height) cell_y = grid->height - 1;
+    return cell_x + cell_y * grid->width;
+}
+
+static inline float fast_inv_sqrt(float x) {
+    float xhalf = 0.5f * x;
+    union { float f; int32_t i; } conv = { .f = x };
+    conv.i = 0x5f3759df - (conv.i >> 1);
+    conv.f = conv.f * (1.5f - xhalf * conv.f * conv.f);
+    return conv.f;
+}
+
+static void spawn_boids(freecs_world_t* world, size_t count, float screen_w, float screen_h) {
+    Position* positions = malloc(count * sizeof(Position));
+    Velocity* velocities = malloc(count * sizeof(Velocity));
+    for (size_t i = 0; i < count; i++) {
+        float angle = rand_float() * 3.14159265f * 2.0f;
+        float speed = rand_range(100.0f, 200.0f);
+        positions[i] = (Position){rand_range(0, screen_w), rand_range(0, screen_h)};
+        velocities[i] = (Velocity){cosf(angle) * speed, sinf(angle) * speed};
+    }
+
+    const void* sources[3] = {positions, velocities, NULL};
+    size_t spawned;
+    free(freecs_spawn_batch_columns(world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_BOID), count, sources, &spawned));
+
+    free(positions);
+    free(velocities);
+}
+
+static void build_grid(freecs_world_t* world, SpatialGrid* grid) {
+    memset(grid->cell_starts, 0, ((size_t)grid->total + 1) * sizeof(uint32_t));
+
+    size_t boid_count = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_BOID), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Position* positions = FREECS_ITER_COLUMN(&result, Position, BIT_POSITION);
+        Velocity* velocities = FREECS_ITER_COLUMN(&result, Velocity, BIT_VELOCITY);
+        for (size_t i = 0; i < result.row_count && boid_count < grid->capacity; i++) {
+            Position p = positions[i];
+            Velocity v = velocities[i];
+            grid->scratch[boid_count++] = (BoidData){p.x, p.y, v.x, v.y};
+            grid->cell_starts[grid_cell(grid, p.x, p.y) + 1]++;
+        }
+    }
+
+    for (int c = 0; c < grid->total; c++) {
+        grid->cell_starts[c + 1] += grid->cell_starts[c];
+    }
+    for (size_t i = 0; i < boid_count; i++) {
+        BoidData b = grid->scratch[i];
+        grid->boids[grid->cell_starts[grid_cell(grid, b.x, b.y)]++] = b;
+    }
+    for (int c = grid->total; c > 0; c--) {
+        grid->cell_starts[c] = grid->cell_starts[c - 1];
+    }
+    grid->cell_starts[0] = 0;
+}
+
+static void steer_boids(const SpatialGrid* grid, const BoidParams* params, const Position* positions, Velocity* velocities, size_t count) {
+    const int MAX_NEIGHBORS = 7;
+    float visual_range_sq = params->visual_range_sq;
+    float max_sq = params->max_speed * params->max_speed;
+    float min_sq = params->min_speed * params->min_speed;
+
+    for (size_t i = 0; i < count; i++) {
+        Position pos = positions[i];
+        Velocity vel = velocities[i];
+
+        float align_x = 0, align_y = 0;
+        float cohesion_x = 0, cohesion_y = 0;
+        float sep_x = 0, sep_y = 0;
+        int neighbors = 0;
+
+        int cell_x = (int)(pos.x * grid->inv_cell);
+        int cell_y = (int)(pos.y * grid->inv_cell);
+
+        for (int dy = -grid->range_cells; dy <= grid->range_cells && neighbors < MAX_NEIGHBORS; dy++) {
+            int cy = cell_y + dy;
+            if (cy < 0 || cy >= grid->height) continue;
+
+            for (int dx = -grid->range_cells; dx <= grid->range_cells && neighbors < MAX_NEIGHBORS; dx++) {
+                int cx = cell_x + dx;
+                if (cx < 0 || cx >= grid->width) continue;
+
+                int cell_idx = cx + cy * grid->width;
+                uint32_t end = grid->cell_starts[cell_idx + 1];
+
+                for (uint32_t j = grid->cell_starts[cell_idx]; j < end && neighbors < MAX_NEIGHBORS; j++) {
+                    BoidData b = grid->boids[j];
+                    float bx = b.x - pos.x;
+                    float by = b.y - pos.y;
+                    float dist_sq = bx * bx + by * by;
+
+                    if (dist_sq > 0 && dist_sq < visual_range_sq) {
+                        align_x += b.vx;
+                        align_y += b.vy;
+                        cohesion_x += b.x;
+                        cohesion_y += b.y;
+                        float inv_dist = fast_inv_sqrt(dist_sq);
+                        sep_x -= bx * inv_dist;
+                        sep_y -= by * inv_dist;
+                        neighbors++;
+                    }
+                }
+            }
+        }
+
+        if (neighbors > 0) {
+            float inv = 1.0f / (float)neighbors;
+            vel.x += (align_x * inv) * params->alignment_weight;
+            vel.y += (align_y * inv) * params->alignment_weight;
+            vel.x += (cohesion_x * inv - pos.x) * params->cohesion_weight;
+            vel.y += (cohesion_y * inv - pos.y) * params->cohesion_weight;
+            vel.x += sep_x * params->separation_weight;
+            vel.y += sep_y * params->separation_weight;
+        }
+
+        float speed_sq = vel.x * vel.x + vel.y * vel.y;
+        if (speed_sq > max_sq) {
+            float f = params->max_speed * fast_inv_sqrt(speed_sq);
+            vel.x *= f;
+            vel.y *= f;
+        } else if (speed_sq < min_sq && speed_sq > 0) {
+            float f = params->min_speed * fast_inv_sqrt(speed_sq);
+            vel.x *= f;
+            vel.y *= f;
+        }
+
+        velocities[i] = vel;
+    }
+}
+
+static void move_boids(const TickContext* ctx, Position* positions, const Velocity* velocities, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        Position* p = &positions[i];
+        p->x += velocities[i].x * ctx->dt;
+        p->y += velocities[i].y * ctx->dt;
+        if (p->x < 0) p->x += ctx->screen_w;
+        else if (p->x > ctx->screen_w) p->x -= ctx->screen_w;
+        if (p->y < 0) p->y += ctx->screen_h;
+        else if (p->y > ctx->screen_h) p->y -= ctx->screen_h;
+    }
+}
+
+static void process_boids(freecs_world_t* world, TickContext* ctx) {
+    build_grid(world, ctx->grid);
+
+    freecs_table_iterator_t iter = freecs_table_iterator(world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_BOID), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        steer_boids(ctx->grid, ctx->params,
+                    FREECS_ITER_COLUMN(&result, Position, BIT_POSITION),
+                    FREECS_ITER_COLUMN(&result, Velocity, BIT_VELOCITY),
+                    result.row_count);
+    }
+
+    iter = freecs_table_iterator(world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), FREECS_MASK_EMPTY);
+    while (freecs_table_iterator_next(&iter, &result)) {
+        move_boids(ctx,
+                   FREECS_ITER_COLUMN(&result, Position, BIT_POSITION),
+                   FREECS_ITER_COLUMN(&result, Velocity, BIT_VELOCITY),
+                   result.row_count);
+    }
+}
+
+static void steer_view(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    (void)thread_index;
+    TickContext* ctx = user;
+    steer_boids(ctx->grid, ctx->params,
+                FREECS_ITER_COLUMN(view, Position, BIT_POSITION),
+                FREECS_ITER_COLUMN(view, Velocity, BIT_VELOCITY),
+                view->row_count);
+}
+
+static void move_view(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    (void)thread_index;
+    move_boids(user,
+               FREECS_ITER_COLUMN(view, Position, BIT_POSITION),
+               FREECS_ITER_COLUMN(view, Velocity, BIT_VELOCITY),
+               view->row_count);
+}
+
+static void process_boids_parallel(freecs_world_t* world, freecs_thread_pool_t* pool, TickContext* ctx) {
+    build_grid(world, ctx->grid);
+    freecs_par_for_each_table(pool, world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_BOID), FREECS_MASK_EMPTY, steer_view, ctx);
+    freecs_par_for_each_table(pool, world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), FREECS_MASK_EMPTY, move_view, ctx);
+}
+
+static void print_usage(const char* program) {
+    printf("Usage: %s [boids] [ticks] [--parallel [threads]]\n", program);
+}
+
+static bool parse_positive(const char* text, size_t limit, size_t* out) {
+    char* end;
+    errno = 0;
+    unsigned long long value = strtoull(text, &end, 10);
+    if (end == text || *end != '\0' || errno != 0 || text[0] == '-' || value == 0 || value > limit) return false;
+    *out = (size_t)value;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    size_t boid_count = 10000;
+    int ticks = 1000;
+    size_t threads = 0;
+
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--parallel") == 0) {
+            threads = 4;
+            if (i + 1 < argc && argv[i + 1][0] != '-' && !parse_positive(argv[++i], 1024, &threads)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (positional == 0) {
+            if (!parse_positive(argv[i], UINT32_MAX, &boid_count)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+            positional++;
+        } else if (positional == 1) {
+            size_t parsed;
+            if (!parse_positive(argv[i], INT_MAX, &parsed)) {
+                print_usage(argv[0]);
+                return 1;
+            }
+            ticks = (int)parsed;
+            positional++;
+        } else {
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (boid_count == 0 || ticks <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    float scale = sqrtf((float)boid_count / 1000.0f);
+    float screen_w = 1280.0f * scale;
+    float screen_h = 720.0f * scale;
+
+    freecs_world_t world = freecs_create_world();
+
+    BIT_POSITION = FREECS_REGISTER_ALIGNED(&world, Position, 32);
+    BIT_VELOCITY = FREECS_REGISTER_ALIGNED(&world, Velocity, 32);
+    BIT_BOID = FREECS_REGISTER(&world, Boid);
+
+    float visual_range = 50.0f;
+    BoidParams params = {
+        .alignment_weight = 0.5f,
+        .cohesion_weight = 0.3f,
+        .separation_weight = 0.4f,
+        .visual_range = visual_range,
+        .visual_range_sq = visual_range * visual_range,
+        .min_speed = 100.0f,
+        .max_speed = 300.0f
+    };
+
+    SpatialGrid grid = create_grid(screen_w, screen_h, visual_range / 2.0f, visual_range, boid_count);
+    spawn_boids(&world, boid_count, screen_w, screen_h);
+
+    TickContext ctx = {&grid, &params, 1.0f / 60.0f, screen_w, screen_h};
+    freecs_thread_pool_t* pool = threads > 0 ? freecs_create_thread_pool(threads) : NULL;
+
+    printf("boids: %zu, ticks: %d, world: %.0fx%.0f, mode: ", boid_count, ticks, screen_w, screen_h);
+    if (pool != NULL) {
+        printf("parallel (%zu threads)\n", freecs_thread_pool_size(pool));
+    } else {
+        printf("serial\n");
+    }
+
+    double start = now_seconds();
+    for (int tick = 0; tick < ticks; tick++) {
+        if (pool != NULL) {
+            process_boids_parallel(&world, pool, &ctx);
+        } else {
+            process_boids(&world, &ctx);
+        }
+    }
+    double elapsed = now_seconds() - start;
+
+    printf("elapsed: %.3f s\n", elapsed);
+    printf("ticks/sec: %.1f\n", (double)ticks / elapsed);
+    printf("ms/tick: %.3f\n", elapsed * 1000.0 / (double)ticks);
+    printf("boid updates/sec: %.2f M\n", (double)boid_count * (double)ticks / elapsed / 1e6);
+
+    if (pool != NULL) freecs_destroy_thread_pool(pool);
+    destroy_grid(&grid);
+    freecs_destroy_world(&world);
+
+    return 0;
+}
@@ -156,7 +156,8 @@ static uint64_t BIT_VISUAL_EFFECT;
 static uint64_t BIT_MONEY_POPUP;
 
 static freecs_event_queue_t enemy_died_events;
-static freecs_event_queue_t enemy_spawned_events;
+static freecs_event_reader_t reward_reader;
+static freecs_event_reader_t death_effect_reader;
 
 typedef struct {
     freecs_entity_t entity;
@@ -166,11 +167,6 @@ typedef struct {
     EnemyType enemy_type;
 } EnemyDiedEvent;
 
-typedef struct {
-    freecs_entity_t entity;
-    EnemyType enemy_type;
-} EnemySpawnedEvent;
-
 static float random_float(void) {
     return (float)rand() / (float)RAND_MAX;
 }
@@ -526,12 +522,7 @@ static freecs_entity_t spawn_enemy(EnemyType type) {
         {BIT_ENEMY, sizeof(Enemy), &enemy, freecs_bit_index(BIT_ENEMY)}
     };
 
-    freecs_entity_t entity = freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY | BIT_ENEMY, entries, 3);
-
-    EnemySpawnedEvent event = {entity, type};
-    freecs_send_event(&enemy_spawned_events, &event);
-
-    return entity;
+    return freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY | BIT_ENEMY, entries, 3);
 }
 
 static freecs_entity_t spawn_projectile(float from_x, float from_y, freecs_entity_t target, TowerType tower_type, uint32_t level) {
@@ -1166,32 +1157,39 @@ static void update_money_popups(float delta_time) {
     freecs_apply_despawns(&world);
 }
 
-static void enemy_died_event_handler(void) {
+static void enemy_reward_system(void) {
     size_t event_count;
-    EnemyDiedEvent* events = FREECS_READ_EVENTS(&enemy_died_events, EnemyDiedEvent, &event_count);
-
-    for (size_t i = 0; i < event_count; i++) {
-        resources.money += events[i].reward;
-
-        for (int k = 0; k < 6; k++) {
-            float velocity_x = random_range(-40, 40);
-            float velocity_y = random_range(-40, 40);
-            spawn_visual_effect(events[i].pos_x, events[i].pos_y, EFFECT_DEATH_PARTICLE, velocity_x, velocity_y, 0.8f);
+    EnemyDiedEvent* events;
+    while ((events = FREECS_READ_NEW_EVENTS(&enemy_died_events, &reward_reader, EnemyDiedEvent, &event_count)) != NULL) {
+        for (size_t i = 0; i < event_count; i++) {
+            resources.money += events[i].reward;
+            if (events[i].reward > 0) {
+                spawn_money_popup(events[i].pos_x, events[i].pos_y, (int)events[i].reward);
+            }
         }
+    }
+}
 
-        if (events[i].reward > 0) {
-            spawn_money_popup(events[i].pos_x, events[i].pos_y, (int)events[i].reward);
+static void enemy_death_effect_system(void) {
+    size_t event_count;
+    EnemyDiedEvent* events;
+    while ((events = FREECS_READ_NEW_EVENTS(&enemy_died_events, &death_effect_reader, EnemyDiedEvent, &event_count)) != NULL) {
+        for (size_t i = 0; i < event_count; i++) {
+            for (int k = 0; k < 6; k++) {
+                float velocity_x = random_range(-40, 40);
+                float velocity_y = random_range(-40, 40);
+                spawn_visual_effect(events[i].pos_x, events[i].pos_y, EFFECT_DEATH_PARTICLE, velocity_x, velocity_y, 0.8f);
+            }
         }
     }
-    freecs_clear_events(&enemy_died_events);
 }
 
 static void enemy_spawned_event_handler(void) {
-    size_t event_count;
-    EnemySpawnedEvent* events = FREECS_READ_EVENTS(&enemy_spawned_events, EnemySpawnedEvent, &event_count);
+    size_t spawned_count;
+    const freecs_entity_t* spawned = freecs_added(&world, BIT_ENEMY, &spawned_count);
 
-    for (size_t i = 0; i < event_count; i++) {
-        Position* pos = FREECS_GET(&world, events[i].entity, Position, BIT_POSITION);
+    for (size_t i = 0; i < spawned_count; i++) {
+        Position* pos = FREECS_GET(&world, spawned[i], Position, BIT_POSITION);
         if (pos) {
             for (int k = 0; k < 4; k++) {
                 float velocity_x = random_range(-30, 30);
@@ -1200,7 +1198,6 @@ static void enemy_spawned_event_handler(void) {
             }
         }
     }
-    freecs_clear_events(&enemy_spawned_events);
 }
 
 static void sell_tower(freecs_entity_t tower_entity, int grid_x, int grid_y) {
@@ -1795,7 +1792,9 @@ int main(void) {
     BIT_MONEY_POPUP = FREECS_REGISTER(&world, MoneyPopup);
 
     enemy_died_events = FREECS_CREATE_EVENT_QUEUE(EnemyDiedEvent);
-    enemy_spawned_events = FREECS_CREATE_EVENT_QUEUE(EnemySpawnedEvent);
+    reward_reader = freecs_event_reader(&enemy_died_events);
+    death_effect_reader = freecs_event_reader(&enemy_died_events);
+    freecs_observe_components(&world, BIT_ENEMY);
 
     resources.money = 200;
     resources.lives = 1;
@@ -1829,9 +1828,12 @@ int main(void) {
             visual_effects_system(dt);
             update_money_popups(dt);
 
-            enemy_died_event_handler();
+            enemy_reward_system();
+            enemy_death_effect_system();
             enemy_spawned_event_handler();
         }
+        freecs_update_events(&enemy_died_events);
+        freecs_clear_component_events(&world);
 
         if (resources.wave_announce_timer > 0) {
             resources.wave_announce_timer -= base_dt;
@@ -1852,7 +1854,6 @@ int main(void) {
     }
 
     freecs_destroy_event_queue(&enemy_died_events);
-    freecs_destroy_event_queue(&enemy_spawned_events);
     freecs_destroy_world(&world);
     CloseWindow();
 
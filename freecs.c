@@ -1,6 +1,13 @@
 #include "freecs.h"
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+#define FREECS_DEFAULT_ALIGN _Alignof(max_align_t)
 
 static void ensure_capacity_u8(uint8_t** data, size_t* cap, size_t needed) {
     if (needed <= *cap) return;
@@ -10,6 +17,35 @@ static void ensure_capacity_u8(uint8_t** data, size_t* cap, size_t needed) {
     *cap = new_cap;
 }
 
+static uint8_t* aligned_alloc_block(size_t align, size_t bytes) {
+#ifdef _WIN32
+    return _aligned_malloc(bytes, align);
+#else
+    return aligned_alloc(align, bytes);
+#endif
+}
+
+static void aligned_free_block(uint8_t* block) {
+#ifdef _WIN32
+    _aligned_free(block);
+#else
+    free(block);
+#endif
+}
+
+#ifndef FREECS_CHUNKED_STORAGE
+static void ensure_capacity_u8_aligned(uint8_t** data, size_t* cap, size_t needed, size_t align) {
+    if (needed <= *cap) return;
+    size_t new_cap = *cap == 0 ? align : *cap * 2;
+    while (new_cap < needed) new_cap *= 2;
+    uint8_t* new_data = aligned_alloc_block(align, new_cap);
+    if (*cap > 0) memcpy(new_data, *data, *cap);
+    aligned_free_block(*data);
+    *data = new_data;
+    *cap = new_cap;
+}
+#endif
+
 static void ensure_capacity_entities(freecs_entity_t** data, size_t* cap, size_t needed) {
     if (needed <= *cap) return;
     size_t new_cap = *cap == 0 ? 16 : *cap * 2;
@@ -42,19 +78,45 @@ static void ensure_capacity_columns(freecs_component_column_t** data, size_t* ca
     *cap = new_cap;
 }
 
-static void ensure_capacity_indices(size_t** data, size_t* cap, size_t needed) {
+#ifdef FREECS_CHUNKED_STORAGE
+static void ensure_capacity_chunks(uint8_t*** data, size_t* cap, size_t needed) {
+    if (needed <= *cap) return;
+    size_t new_cap = *cap == 0 ? 4 : *cap * 2;
+    while (new_cap < needed) new_cap *= 2;
+    *data = realloc(*data, new_cap * sizeof(uint8_t*));
+    *cap = new_cap;
+}
+#endif
+
+static void ensure_capacity_views(freecs_table_iterator_result_t** data, size_t* cap, size_t needed) {
+    if (needed <= *cap) return;
+    size_t new_cap = *cap == 0 ? 64 : *cap * 2;
+    while (new_cap < needed) new_cap *= 2;
+    *data = realloc(*data, new_cap * sizeof(freecs_table_iterator_result_t));
+    *cap = new_cap;
+}
+
+static void ensure_capacity_systems(freecs_system_t** data, size_t* cap, size_t needed) {
+    if (needed <= *cap) return;
+    size_t new_cap = *cap == 0 ? 8 : *cap * 2;
+    while (new_cap < needed) new_cap *= 2;
+    *data = realloc(*data, new_cap * sizeof(freecs_system_t));
+    *cap = new_cap;
+}
+
+static void ensure_capacity_segments(freecs_command_segment_t** data, size_t* cap, size_t needed) {
     if (needed <= *cap) return;
     size_t new_cap = *cap == 0 ? 16 : *cap * 2;
     while (new_cap < needed) new_cap *= 2;
-    *data = realloc(*data, new_cap * sizeof(size_t));
+    *data = realloc(*data, new_cap * sizeof(freecs_command_segment_t));
     *cap = new_cap;
 }
 
-static void ensure_capacity_cache(freecs_cache_entry_t** data, size_t* cap, size_t needed) {
+static void ensure_capacity_indices(size_t** data, size_t* cap, size_t needed) {
     if (needed <= *cap) return;
     size_t new_cap = *cap == 0 ? 16 : *cap * 2;
     while (new_cap < needed) new_cap *= 2;
-    *data = realloc(*data, new_cap * sizeof(freecs_cache_entry_t));
+    *data = realloc(*data, new_cap * sizeof(size_t));
     *cap = new_cap;
 }
 
@@ -68,56 +130,511 @@ static void ensure_capacity_commands(freecs_command_t** data, size_t* cap, size_
 
 
 
-static void ensure_capacity_tag_entries(freecs_tag_entry_t** data, size_t* cap, size_t needed) {
+static void ensure_capacity_spatial_entries(freecs_spatial_entry_t** data, size_t* cap, size_t needed) {
+    if (needed <= *cap) return;
+    size_t new_cap = *cap == 0 ? 8 : *cap * 2;
+    while (new_cap < needed) new_cap *= 2;
+    *data = realloc(*data, new_cap * sizeof(freecs_spatial_entry_t));
+    *cap = new_cap;
+}
+
+static void ensure_capacity_spatial_slots(freecs_spatial_slot_t** data, size_t* cap, size_t needed) {
+    if (needed <= *cap) return;
+    size_t new_cap = *cap == 0 ? 64 : *cap * 2;
+    while (new_cap < needed) new_cap *= 2;
+    *data = realloc(*data, new_cap * sizeof(freecs_spatial_slot_t));
+    *cap = new_cap;
+}
+
+static void ensure_capacity_spatial_hits(freecs_spatial_hit_t** data, size_t* cap, size_t needed) {
     if (needed <= *cap) return;
     size_t new_cap = *cap == 0 ? 16 : *cap * 2;
     while (new_cap < needed) new_cap *= 2;
-    *data = realloc(*data, new_cap * sizeof(freecs_tag_entry_t));
+    *data = realloc(*data, new_cap * sizeof(freecs_spatial_hit_t));
     *cap = new_cap;
 }
 
-static size_t cache_find(freecs_cache_entry_t* cache, size_t len, uint64_t key) {
-    for (size_t i = 0; i < len; i++) {
-        if (cache[i].key == key) return i;
+static inline size_t hash_u64(uint64_t key) {
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdULL;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ULL;
+    key ^= key >> 33;
+    return (size_t)key;
+}
+
+static inline size_t hash_mask(freecs_mask_t mask) {
+#ifdef FREECS_WIDE_MASK
+    uint64_t hash = 0;
+    for (size_t i = 0; i < FREECS_MASK_WORDS; i++) {
+        hash = (uint64_t)hash_u64(hash ^ mask.words[i]);
+    }
+    return (size_t)hash;
+#else
+    return hash_u64(mask);
+#endif
+}
+
+static size_t archetype_index_find(const freecs_world_t* world, freecs_mask_t mask) {
+    if (world->archetype_index_cap == 0) return (size_t)-1;
+
+    size_t slot_mask = world->archetype_index_cap - 1;
+    size_t slot = hash_mask(mask) & slot_mask;
+    while (world->archetype_index[slot].occupied) {
+        if (freecs_mask_equal(world->archetype_index[slot].mask, mask)) {
+            return world->archetype_index[slot].archetype_index;
+        }
+        slot = (slot + 1) & slot_mask;
     }
     return (size_t)-1;
 }
 
+static void archetype_index_place(freecs_archetype_slot_t* slots, size_t cap, freecs_mask_t mask, size_t arch_idx) {
+    size_t slot_mask = cap - 1;
+    size_t slot = hash_mask(mask) & slot_mask;
+    while (slots[slot].occupied) {
+        slot = (slot + 1) & slot_mask;
+    }
+    slots[slot] = (freecs_archetype_slot_t){mask, arch_idx, true};
+}
+
+static void archetype_index_insert(freecs_world_t* world, freecs_mask_t mask, size_t arch_idx) {
+    if ((world->archetype_index_len + 1) * 2 > world->archetype_index_cap) {
+        size_t new_cap = world->archetype_index_cap == 0 ? 16 : world->archetype_index_cap * 2;
+        freecs_archetype_slot_t* slots = calloc(new_cap, sizeof(freecs_archetype_slot_t));
+        for (size_t i = 0; i < world->archetype_index_cap; i++) {
+            freecs_archetype_slot_t* old = &world->archetype_index[i];
+            if (old->occupied) {
+                archetype_index_place(slots, new_cap, old->mask, old->archetype_index);
+            }
+        }
+        free(world->archetype_index);
+        world->archetype_index = slots;
+        world->archetype_index_cap = new_cap;
+    }
+
+    archetype_index_place(world->archetype_index, world->archetype_index_cap, mask, arch_idx);
+    world->archetype_index_len++;
+}
+
+#define EDGE_EMPTY_KEY UINT32_MAX
+
+static inline uint32_t edge_key(size_t bit_idx, bool remove) {
+    return (uint32_t)(bit_idx << 1) | (remove ? 1u : 0u);
+}
+
+static int32_t edge_get(const freecs_table_edges_t* edges, uint32_t key) {
+    for (size_t i = 0; i < edges->inline_len; i++) {
+        if (edges->inline_edges[i].key == key) return edges->inline_edges[i].target;
+    }
+    if (edges->overflow_cap == 0) return -1;
+
+    size_t slot_mask = edges->overflow_cap - 1;
+    size_t slot = hash_u64(key) & slot_mask;
+    while (edges->overflow[slot].key != EDGE_EMPTY_KEY) {
+        if (edges->overflow[slot].key == key) return edges->overflow[slot].target;
+        slot = (slot + 1) & slot_mask;
+    }
+    return -1;
+}
+
+static void edge_place(freecs_edge_t* slots, size_t cap, uint32_t key, int32_t target) {
+    size_t slot_mask = cap - 1;
+    size_t slot = hash_u64(key) & slot_mask;
+    while (slots[slot].key != EDGE_EMPTY_KEY && slots[slot].key != key) {
+        slot = (slot + 1) & slot_mask;
+    }
+    slots[slot] = (freecs_edge_t){key, target};
+}
+
+static void edge_set(freecs_table_edges_t* edges, uint32_t key, int32_t target) {
+    for (size_t i = 0; i < edges->inline_len; i++) {
+        if (edges->inline_edges[i].key == key) {
+            edges->inline_edges[i].target = target;
+            return;
+        }
+    }
+    if (edges->inline_len < FREECS_INLINE_EDGES) {
+        edges->inline_edges[edges->inline_len++] = (freecs_edge_t){key, target};
+        return;
+    }
+
+    if ((edges->overflow_len + 1) * 2 > edges->overflow_cap) {
+        size_t new_cap = edges->overflow_cap == 0 ? 8 : edges->overflow_cap * 2;
+        freecs_edge_t* slots = malloc(new_cap * sizeof(freecs_edge_t));
+        for (size_t i = 0; i < new_cap; i++) {
+            slots[i].key = EDGE_EMPTY_KEY;
+        }
+        for (size_t i = 0; i < edges->overflow_cap; i++) {
+            if (edges->overflow[i].key != EDGE_EMPTY_KEY) {
+                edge_place(slots, new_cap, edges->overflow[i].key, edges->overflow[i].target);
+            }
+        }
+        free(edges->overflow);
+        edges->overflow = slots;
+        edges->overflow_cap = new_cap;
+    }
+
+    if (edge_get(edges, key) < 0) edges->overflow_len++;
+    edge_place(edges->overflow, edges->overflow_cap, key, target);
+}
+
+static inline size_t hash_query(freecs_mask_t include, freecs_mask_t exclude) {
+    return hash_u64((uint64_t)hash_mask(include) ^ (uint64_t)hash_mask(exclude) * 0x9e3779b97f4a7c15ULL);
+}
+
+static freecs_cache_entry_t* query_cache_find(freecs_world_t* world, freecs_mask_t include, freecs_mask_t exclude) {
+    if (world->query_cache_cap == 0) return NULL;
+
+    size_t slot_mask = world->query_cache_cap - 1;
+    size_t slot = hash_query(include, exclude) & slot_mask;
+    while (world->query_cache[slot].occupied) {
+        freecs_cache_entry_t* entry = &world->query_cache[slot];
+        if (freecs_mask_equal(entry->include, include) && freecs_mask_equal(entry->exclude, exclude)) {
+            return entry;
+        }
+        slot = (slot + 1) & slot_mask;
+    }
+    return NULL;
+}
+
+static freecs_cache_entry_t* query_cache_place(freecs_cache_entry_t* entries, size_t cap, freecs_mask_t include, freecs_mask_t exclude) {
+    size_t slot_mask = cap - 1;
+    size_t slot = hash_query(include, exclude) & slot_mask;
+    while (entries[slot].occupied) {
+        slot = (slot + 1) & slot_mask;
+    }
+    entries[slot].include = include;
+    entries[slot].exclude = exclude;
+    entries[slot].occupied = true;
+    return &entries[slot];
+}
+
+static freecs_cache_entry_t* query_cache_insert(freecs_world_t* world, freecs_mask_t include, freecs_mask_t exclude, freecs_index_array_t value) {
+    if ((world->query_cache_len + 1) * 2 > world->query_cache_cap) {
+        size_t new_cap = world->query_cache_cap == 0 ? 16 : world->query_cache_cap * 2;
+        freecs_cache_entry_t* entries = calloc(new_cap, sizeof(freecs_cache_entry_t));
+        for (size_t i = 0; i < world->query_cache_cap; i++) {
+            freecs_cache_entry_t* old = &world->query_cache[i];
+            if (old->occupied) {
+                query_cache_place(entries, new_cap, old->include, old->exclude)->value = old->value;
+            }
+        }
+        free(world->query_cache);
+        world->query_cache = entries;
+        world->query_cache_cap = new_cap;
+    }
+
+    freecs_cache_entry_t* entry = query_cache_place(world->query_cache, world->query_cache_cap, include, exclude);
+    entry->value = value;
+    world->query_cache_len++;
+    return entry;
+}
+
+static inline size_t align_up(size_t value, size_t align) {
+    return (value + align - 1) & ~(align - 1);
+}
+
+#ifdef FREECS_CHUNKED_STORAGE
+static size_t layout_chunk(freecs_archetype_t* arch, size_t rows) {
+    size_t offset = 0;
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        freecs_component_column_t* col = &arch->columns[c];
+        offset = align_up(offset, col->elem_align > FREECS_CHUNK_ALIGN ? col->elem_align : FREECS_CHUNK_ALIGN);
+        col->chunk_offset = offset;
+        offset += rows * col->elem_size;
+    }
+    return align_up(offset, arch->chunk_align);
+}
+
+static void init_chunk_layout(freecs_archetype_t* arch) {
+    size_t stride = 0;
+    arch->chunk_align = FREECS_CHUNK_ALIGN;
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        stride += arch->columns[c].elem_size;
+        if (arch->columns[c].elem_align > arch->chunk_align) {
+            arch->chunk_align = arch->columns[c].elem_align;
+        }
+    }
+
+    size_t rows = 1;
+    size_t shift = 0;
+    while (rows * 2 <= FREECS_CHUNK_SIZE && rows * 2 * stride <= FREECS_CHUNK_SIZE) {
+        rows *= 2;
+        shift++;
+    }
+    while (rows > 1 && layout_chunk(arch, rows) > FREECS_CHUNK_SIZE) {
+        rows /= 2;
+        shift--;
+    }
+
+    size_t bytes = layout_chunk(arch, rows);
+    arch->chunk_rows = rows;
+    arch->chunk_shift = shift;
+    arch->chunk_bytes = bytes > FREECS_CHUNK_SIZE ? bytes : align_up(FREECS_CHUNK_SIZE, arch->chunk_align);
+}
+#endif
+
+static inline uint8_t* column_row(const freecs_archetype_t* arch, const freecs_component_column_t* col, size_t row) {
+#ifdef FREECS_CHUNKED_STORAGE
+    return arch->chunks[row >> arch->chunk_shift] + col->chunk_offset + (row & (arch->chunk_rows - 1)) * col->elem_size;
+#else
+    (void)arch;
+    return &col->data[row * col->elem_size];
+#endif
+}
+
+static inline size_t change_blocks(const freecs_archetype_t* arch, size_t rows) {
+    return (rows + ((size_t)1 << arch->change_shift) - 1) >> arch->change_shift;
+}
+
+static void reserve_column_ticks(const freecs_archetype_t* arch, freecs_component_column_t* col, size_t rows) {
+    if (rows <= col->ticks_cap) return;
+    size_t new_cap = col->ticks_cap == 0 ? FREECS_MIN_ENTITY_CAPACITY : col->ticks_cap * 2;
+    while (new_cap < rows) new_cap *= 2;
+    size_t old_blocks = change_blocks(arch, col->ticks_cap);
+    size_t new_blocks = change_blocks(arch, new_cap);
+    col->ticks = realloc(col->ticks, new_cap * sizeof(uint32_t));
+    col->block_ticks = realloc(col->block_ticks, new_blocks * sizeof(uint32_t));
+    memset(&col->block_ticks[old_blocks], 0, (new_blocks - old_blocks) * sizeof(uint32_t));
+    col->ticks_cap = new_cap;
+}
+
+static inline void set_row_tick(const freecs_archetype_t* arch, freecs_component_column_t* col, size_t row, uint32_t tick) {
+    col->ticks[row] = tick;
+    uint32_t* block = &col->block_ticks[row >> arch->change_shift];
+    if (*block < tick) *block = tick;
+}
+
+static void mark_rows(const freecs_archetype_t* arch, freecs_component_column_t* col, size_t start, size_t count, uint32_t tick) {
+    if (count == 0) return;
+    for (size_t row = start; row < start + count; row++) {
+        col->ticks[row] = tick;
+    }
+    size_t last = (start + count - 1) >> arch->change_shift;
+    for (size_t block = start >> arch->change_shift; block <= last; block++) {
+        if (col->block_ticks[block] != tick) col->block_ticks[block] = tick;
+    }
+}
+
+static void mark_new_rows(const freecs_world_t* world, freecs_archetype_t* arch, size_t start, size_t count) {
+    if (!arch->tracked) return;
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        if (arch->columns[c].tracked) mark_rows(arch, &arch->columns[c], start, count, world->change_tick);
+    }
+}
+
+static inline void touch_row(const freecs_world_t* world, const freecs_archetype_t* arch, freecs_component_column_t* col, size_t row) {
+    if (col->tracked) set_row_tick(arch, col, row, world->change_tick);
+}
+
+static void record_transition(freecs_world_t* world, freecs_mask_t from, freecs_mask_t to, const freecs_entity_t* entities, size_t count) {
+    if (freecs_mask_is_empty(world->observed)) return;
+    freecs_mask_t added = freecs_mask_and(freecs_mask_andnot(to, from), world->observed);
+    freecs_mask_t removed = freecs_mask_and(freecs_mask_andnot(from, to), world->observed);
+    if (freecs_mask_is_empty(freecs_mask_or(added, removed))) return;
+
+    for (size_t bit_idx = 0; bit_idx < world->next_component; bit_idx++) {
+        freecs_component_events_t* events = &world->component_events[bit_idx];
+        if (freecs_mask_test(added, bit_idx)) {
+            ensure_capacity_entities(&events->added, &events->added_cap, events->added_len + count);
+            memcpy(&events->added[events->added_len], entities, count * sizeof(freecs_entity_t));
+            events->added_len += count;
+        } else if (freecs_mask_test(removed, bit_idx)) {
+            ensure_capacity_entities(&events->removed, &events->removed_cap, events->removed_len + count);
+            memcpy(&events->removed[events->removed_len], entities, count * sizeof(freecs_entity_t));
+            events->removed_len += count;
+        }
+    }
+}
+
+static void archetype_reserve(freecs_archetype_t* arch, size_t rows) {
+    ensure_capacity_entities(&arch->entities, &arch->entities_cap, rows);
+    if (arch->tracked) {
+        for (size_t c = 0; c < arch->columns_len; c++) {
+            if (arch->columns[c].tracked) reserve_column_ticks(arch, &arch->columns[c], arch->entities_cap);
+        }
+    }
+#ifdef FREECS_CHUNKED_STORAGE
+    size_t needed = (rows + arch->chunk_rows - 1) >> arch->chunk_shift;
+    if (needed <= arch->chunks_len) return;
+    ensure_capacity_chunks(&arch->chunks, &arch->chunks_cap, needed);
+    while (arch->chunks_len < needed) {
+        arch->chunks[arch->chunks_len++] = aligned_alloc_block(arch->chunk_align, arch->chunk_bytes);
+    }
+#else
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        freecs_component_column_t* col = &arch->columns[c];
+        if (col->elem_align > FREECS_DEFAULT_ALIGN) {
+            ensure_capacity_u8_aligned(&col->data, &col->data_cap, rows * col->elem_size, col->elem_align);
+        } else {
+            ensure_capacity_u8(&col->data, &col->data_cap, rows * col->elem_size);
+        }
+    }
+#endif
+}
+
+typedef struct {
+    uint64_t key;
+    uint32_t value;
+} freecs_sort_item_t;
+
+static void radix_sort_items(freecs_sort_item_t* items, freecs_sort_item_t* scratch, size_t count) {
+    size_t first_unsorted = 1;
+    while (first_unsorted < count && items[first_unsorted - 1].key <= items[first_unsorted].key) first_unsorted++;
+    if (first_unsorted >= count) return;
+
+    size_t counts[8][256] = {{0}};
+    for (size_t i = 0; i < count; i++) {
+        uint64_t key = items[i].key;
+        for (size_t digit = 0; digit < 8; digit++) {
+            counts[digit][(key >> (digit * 8)) & 0xff]++;
+        }
+    }
+
+    freecs_sort_item_t* src = items;
+    freecs_sort_item_t* dst = scratch;
+    for (size_t digit = 0; digit < 8; digit++) {
+        size_t shift = digit * 8;
+        if (counts[digit][(src[0].key >> shift) & 0xff] == count) continue;
+
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; bucket++) {
+            size_t bucket_count = counts[digit][bucket];
+            counts[digit][bucket] = offset;
+            offset += bucket_count;
+        }
+        for (size_t i = 0; i < count; i++) {
+            dst[counts[digit][(src[i].key >> shift) & 0xff]++] = src[i];
+        }
+
+        freecs_sort_item_t* swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != items) {
+        memcpy(items, src, count * sizeof(freecs_sort_item_t));
+    }
+}
+
+static uint8_t* world_scratch(freecs_world_t* world, size_t bytes) {
+    ensure_capacity_u8(&world->scratch, &world->scratch_cap, bytes);
+    return world->scratch;
+}
+
+static void archetype_remove_rows(freecs_world_t* world, freecs_archetype_t* arch, size_t* rows, size_t count, size_t* sources, uint8_t* marks) {
+    size_t new_len = arch->entities_len - count;
+    memset(marks, 0, count);
+    size_t moves = 0;
+    for (size_t k = 0; k < count; k++) {
+        if (rows[k] >= new_len) {
+            marks[rows[k] - new_len] = 1;
+        } else {
+            rows[moves++] = rows[k];
+        }
+    }
+
+    size_t source = new_len;
+    for (size_t k = 0; k < moves; k++) {
+        while (marks[source - new_len]) source++;
+        sources[k] = source++;
+    }
+
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        freecs_component_column_t* col = &arch->columns[c];
+        if (col->elem_size == 0) continue;
+        for (size_t k = 0; k < moves; k++) {
+            memcpy(column_row(arch, col, rows[k]), column_row(arch, col, sources[k]), col->elem_size);
+        }
+        if (col->tracked) {
+            for (size_t k = 0; k < moves; k++) {
+                set_row_tick(arch, col, rows[k], col->ticks[sources[k]]);
+            }
+        }
+    }
+
+    for (size_t k = 0; k < moves; k++) {
+        freecs_entity_t moved = arch->entities[sources[k]];
+        arch->entities[rows[k]] = moved;
+        world->locations[moved.id].row = (uint32_t)rows[k];
+    }
+    arch->entities_len = new_len;
+}
+
+static void archetype_swap_remove(freecs_world_t* world, freecs_archetype_t* arch, size_t row) {
+    size_t source;
+    uint8_t mark;
+    archetype_remove_rows(world, arch, &row, 1, &source, &mark);
+}
+
 freecs_world_t freecs_create_world(void) {
     freecs_world_t world = {0};
-    world.next_bit = 1;
     return world;
 }
 
 void freecs_destroy_world(freecs_world_t* world) {
     for (size_t i = 0; i < world->archetypes_len; i++) {
         freecs_archetype_t* arch = &world->archetypes[i];
+#ifdef FREECS_CHUNKED_STORAGE
+        for (size_t j = 0; j < arch->chunks_len; j++) {
+            aligned_free_block(arch->chunks[j]);
+        }
+        free(arch->chunks);
+#else
+        for (size_t j = 0; j < arch->columns_len; j++) {
+            if (arch->columns[j].elem_align > FREECS_DEFAULT_ALIGN) {
+                aligned_free_block(arch->columns[j].data);
+            } else {
+                free(arch->columns[j].data);
+            }
+        }
+#endif
         for (size_t j = 0; j < arch->columns_len; j++) {
-            free(arch->columns[j].data);
+            free(arch->columns[j].ticks);
+            free(arch->columns[j].block_ticks);
         }
         free(arch->columns);
         free(arch->entities);
+        free(arch->edges.overflow);
     }
     free(world->archetypes);
     free(world->locations);
     free(world->free_entities);
-    for (size_t i = 0; i < world->archetype_index_len; i++) {
-        free(world->archetype_index[i].value.indices);
-    }
     free(world->archetype_index);
-    for (size_t i = 0; i < world->query_cache_len; i++) {
-        free(world->query_cache[i].value.indices);
+    for (size_t i = 0; i < world->query_cache_cap; i++) {
+        if (world->query_cache[i].occupied) {
+            free(world->query_cache[i].value.indices);
+        }
     }
     free(world->query_cache);
     free(world->despawn_queue);
+    free(world->scratch);
+    if (world->component_events != NULL) {
+        for (size_t i = 0; i < FREECS_MAX_COMPONENTS; i++) {
+            free(world->component_events[i].added);
+            free(world->component_events[i].removed);
+        }
+        free(world->component_events);
+    }
     memset(world, 0, sizeof(*world));
 }
 
-uint64_t freecs_register_component(freecs_world_t* world, size_t size) {
-    uint64_t bit = world->next_bit;
-    world->next_bit <<= 1;
-    world->type_sizes[freecs_bit_index(bit)] = size;
-    return bit;
+freecs_mask_t freecs_register_component(freecs_world_t* world, size_t size) {
+    return freecs_register_component_aligned(world, size, FREECS_DEFAULT_ALIGN);
+}
+
+freecs_mask_t freecs_register_component_aligned(freecs_world_t* world, size_t size, size_t align) {
+    if (world->next_component >= FREECS_MAX_COMPONENTS) return FREECS_MASK_EMPTY;
+    if (align == 0 || (align & (align - 1)) != 0) return FREECS_MASK_EMPTY;
+    size_t index = world->next_component++;
+    world->type_sizes[index] = size;
+    world->type_aligns[index] = align;
+    return freecs_mask_bit(index);
+}
+
+static inline bool location_holds(const freecs_entity_location_t* loc, freecs_entity_t entity) {
+    return loc->generation == entity.generation && (entity.generation & FREECS_GENERATION_DEAD) == 0;
 }
 
 static void ensure_entity_slot(freecs_world_t* world, uint32_t id) {
@@ -126,7 +643,7 @@ static void ensure_entity_slot(freecs_world_t* world, uint32_t id) {
 
     ensure_capacity_locations(&world->locations, &world->locations_cap, (size_t)id + 1);
     while (world->locations_len <= id) {
-        world->locations[world->locations_len] = (freecs_entity_location_t){0, 0, 0, false};
+        world->locations[world->locations_len] = (freecs_entity_location_t){0, 0, FREECS_GENERATION_DEAD};
         world->locations_len++;
     }
 }
@@ -142,10 +659,58 @@ static freecs_entity_t alloc_entity(freecs_world_t* world) {
     return (freecs_entity_t){id, 0};
 }
 
-static size_t find_or_create_archetype(freecs_world_t* world, uint64_t mask, const freecs_type_info_entry_t* type_info, size_t type_info_count) {
-    size_t idx = cache_find(world->archetype_index, world->archetype_index_len, mask);
-    if (idx != (size_t)-1) {
-        return world->archetype_index[idx].value.indices[0];
+static void take_free_entities(freecs_world_t* world, freecs_entity_t* entities, size_t reused) {
+    world->free_entities_len -= reused;
+    const freecs_entity_t* freed = &world->free_entities[world->free_entities_len];
+    uint32_t lowest = UINT32_MAX;
+    uint32_t highest = 0;
+    for (size_t i = 0; i < reused; i++) {
+        if (freed[i].id < lowest) lowest = freed[i].id;
+        if (freed[i].id > highest) highest = freed[i].id;
+    }
+
+    size_t span = (size_t)(highest - lowest) + 1;
+    if (span <= 8 * reused) {
+        uint8_t* present = world_scratch(world, span);
+        memset(present, 0, span);
+        for (size_t i = 0; i < reused; i++) {
+            present[freed[i].id - lowest] = 1;
+        }
+        size_t next = 0;
+        for (size_t offset = 0; offset < span && next < reused; offset++) {
+            uint32_t id = lowest + (uint32_t)offset;
+            entities[next] = (freecs_entity_t){id, world->locations[id].generation & ~FREECS_GENERATION_DEAD};
+            next += present[offset];
+        }
+    } else {
+        freecs_sort_item_t* items = (freecs_sort_item_t*)world_scratch(world, 2 * reused * sizeof(freecs_sort_item_t));
+        for (size_t i = 0; i < reused; i++) {
+            items[i] = (freecs_sort_item_t){freed[i].id, freed[i].generation};
+        }
+        radix_sort_items(items, items + reused, reused);
+        for (size_t i = 0; i < reused; i++) {
+            entities[i] = (freecs_entity_t){(uint32_t)items[i].key, items[i].value};
+        }
+    }
+}
+
+static void alloc_entities(freecs_world_t* world, freecs_entity_t* entities, size_t count) {
+    size_t reused = count < world->free_entities_len ? count : world->free_entities_len;
+    if (reused > 0) take_free_entities(world, entities, reused);
+    if (reused == count) return;
+
+    uint32_t first = world->next_entity_id;
+    world->next_entity_id += (uint32_t)(count - reused);
+    ensure_entity_slot(world, world->next_entity_id - 1);
+    for (size_t i = reused; i < count; i++) {
+        entities[i] = (freecs_entity_t){first + (uint32_t)(i - reused), 0};
+    }
+}
+
+static size_t find_or_create_archetype(freecs_world_t* world, freecs_mask_t mask, const freecs_type_info_entry_t* type_info, size_t type_info_count) {
+    size_t found_idx = archetype_index_find(world, mask);
+    if (found_idx != (size_t)-1) {
+        return found_idx;
     }
 
     size_t arch_idx = world->archetypes_len;
@@ -157,8 +722,6 @@ static size_t find_or_create_archetype(freecs_world_t* world, uint64_t mask, con
 
     for (size_t i = 0; i < FREECS_MAX_COMPONENTS; i++) {
         arch->column_bits[i] = -1;
-        arch->edges.add_edges[i] = -1;
-        arch->edges.remove_edges[i] = -1;
     }
 
     for (size_t i = 0; i < type_info_count; i++) {
@@ -168,52 +731,45 @@ static size_t find_or_create_archetype(freecs_world_t* world, uint64_t mask, con
         freecs_component_column_t* col = &arch->columns[col_idx];
         memset(col, 0, sizeof(*col));
         col->elem_size = type_info[i].size;
+        col->elem_align = world->type_aligns[freecs_bit_index(type_info[i].bit)];
+        if (col->elem_align == 0) col->elem_align = FREECS_DEFAULT_ALIGN;
         col->bit = type_info[i].bit;
         col->type_index = type_info[i].type_index;
+        col->tracked = col->elem_size > 0 && freecs_mask_intersects(world->tracked, col->bit);
+        arch->tracked |= col->tracked;
 
         arch->column_bits[freecs_bit_index(type_info[i].bit)] = (int32_t)col_idx;
         arch->columns_len++;
     }
 
+    while (((size_t)2 << arch->change_shift) <= FREECS_CHANGE_BLOCK_ROWS) {
+        arch->change_shift++;
+    }
+
+#ifdef FREECS_CHUNKED_STORAGE
+    init_chunk_layout(arch);
+    if (arch->chunk_shift < arch->change_shift) arch->change_shift = arch->chunk_shift;
+#endif
+
     world->archetypes_len++;
 
-    ensure_capacity_cache(&world->archetype_index, &world->archetype_index_cap, world->archetype_index_len + 1);
-    freecs_cache_entry_t* entry = &world->archetype_index[world->archetype_index_len++];
-    entry->key = mask;
-    entry->value.indices = malloc(sizeof(size_t));
-    entry->value.indices[0] = arch_idx;
-    entry->value.len = 1;
-    entry->value.cap = 1;
-
-    for (size_t i = 0; i < world->query_cache_len; i++) {
-        uint64_t query_mask = world->query_cache[i].key & 0xFFFFFFFF;
-        if ((mask & query_mask) == query_mask) {
-            freecs_index_array_t* cached = &world->query_cache[i].value;
+    archetype_index_insert(world, mask, arch_idx);
+
+    for (size_t i = 0; i < world->query_cache_cap; i++) {
+        freecs_cache_entry_t* entry = &world->query_cache[i];
+        if (!entry->occupied) continue;
+        if (freecs_mask_contains(mask, entry->include) && !freecs_mask_intersects(mask, entry->exclude)) {
+            freecs_index_array_t* cached = &entry->value;
             ensure_capacity_indices(&cached->indices, &cached->cap, cached->len + 1);
             cached->indices[cached->len++] = arch_idx;
         }
     }
 
-    for (size_t comp_bit_index = 0; comp_bit_index < FREECS_MAX_COMPONENTS; comp_bit_index++) {
-        uint64_t comp_mask = (uint64_t)1 << comp_bit_index;
-        if (world->type_sizes[comp_bit_index] == 0) continue;
-
-        for (size_t existing_idx = 0; existing_idx < world->archetypes_len; existing_idx++) {
-            freecs_archetype_t* existing = &world->archetypes[existing_idx];
-            if ((existing->mask | comp_mask) == mask) {
-                existing->edges.add_edges[comp_bit_index] = (int32_t)arch_idx;
-            }
-            if ((existing->mask & ~comp_mask) == mask) {
-                existing->edges.remove_edges[comp_bit_index] = (int32_t)arch_idx;
-            }
-        }
-    }
-
     return arch_idx;
 }
 
-freecs_entity_t freecs_spawn(freecs_world_t* world, uint64_t mask, const freecs_type_info_entry_t* entries, size_t entry_count) {
-    if (entry_count == 0 || mask == 0) {
+freecs_entity_t freecs_spawn(freecs_world_t* world, freecs_mask_t mask, const freecs_type_info_entry_t* entries, size_t entry_count) {
+    if (entry_count == 0 || freecs_mask_is_empty(mask)) {
         return FREECS_ENTITY_NIL;
     }
 
@@ -223,52 +779,74 @@ freecs_entity_t freecs_spawn(freecs_world_t* world, uint64_t mask, const freecs_
     freecs_entity_t entity = alloc_entity(world);
     size_t row = arch->entities_len;
 
-    ensure_capacity_entities(&arch->entities, &arch->entities_cap, row + 1);
+    archetype_reserve(arch, row + 1);
     arch->entities[arch->entities_len++] = entity;
 
     for (size_t i = 0; i < entry_count; i++) {
         int32_t col_idx = arch->column_bits[freecs_bit_index(entries[i].bit)];
-        if (col_idx >= 0) {
-            freecs_component_column_t* col = &arch->columns[col_idx];
-            size_t old_len = col->data_len;
-            ensure_capacity_u8(&col->data, &col->data_cap, old_len + entries[i].size);
-            col->data_len = old_len + entries[i].size;
-            if (entries[i].data != NULL && entries[i].size > 0) {
-                memcpy(&col->data[old_len], entries[i].data, entries[i].size);
+        if (col_idx >= 0 && entries[i].size > 0) {
+            uint8_t* dst = column_row(arch, &arch->columns[col_idx], row);
+            if (entries[i].data != NULL) {
+                memcpy(dst, entries[i].data, entries[i].size);
             } else {
-                memset(&col->data[old_len], 0, entries[i].size);
+                memset(dst, 0, entries[i].size);
             }
         }
     }
+    mark_new_rows(world, arch, row, 1);
+    record_transition(world, FREECS_MASK_EMPTY, arch->mask, &entity, 1);
 
     world->locations[entity.id] = (freecs_entity_location_t){
         .generation = entity.generation,
         .archetype_index = (uint32_t)arch_idx,
         .row = (uint32_t)row,
-        .alive = true
     };
 
     return entity;
 }
 
-freecs_entity_t* freecs_spawn_batch(freecs_world_t* world, uint64_t mask, size_t count, size_t* out_count) {
-    if (mask == 0 || count == 0) {
+static void fill_column_rows(freecs_archetype_t* arch, freecs_component_column_t* col, size_t start_row, size_t count, const uint8_t* source) {
+    size_t row = start_row;
+    size_t end = start_row + count;
+    while (row < end) {
+#ifdef FREECS_CHUNKED_STORAGE
+        size_t run = arch->chunk_rows - (row & (arch->chunk_rows - 1));
+        if (run > end - row) run = end - row;
+#else
+        size_t run = end - row;
+#endif
+        uint8_t* dst = column_row(arch, col, row);
+        if (source != NULL) {
+            memcpy(dst, source + (row - start_row) * col->elem_size, run * col->elem_size);
+        } else {
+            memset(dst, 0, run * col->elem_size);
+        }
+        row += run;
+    }
+}
+
+static freecs_entity_t* spawn_rows(freecs_world_t* world, freecs_mask_t mask, size_t count, const void* const* column_sources, size_t* out_count) {
+    if (freecs_mask_is_empty(mask) || count == 0) {
         *out_count = 0;
         return NULL;
     }
 
     freecs_type_info_entry_t type_info[FREECS_MAX_COMPONENTS];
+    const uint8_t* sources[FREECS_MAX_COMPONENTS];
     size_t info_count = 0;
+    size_t source_index = 0;
 
     for (size_t bit_idx = 0; bit_idx < FREECS_MAX_COMPONENTS; bit_idx++) {
-        uint64_t comp_bit = (uint64_t)1 << bit_idx;
-        if ((mask & comp_bit) != 0) {
+        if (freecs_mask_test(mask, bit_idx)) {
+            const uint8_t* source = column_sources != NULL ? column_sources[source_index] : NULL;
+            source_index++;
             size_t size = world->type_sizes[bit_idx];
             if (size > 0) {
-                type_info[info_count].bit = comp_bit;
+                type_info[info_count].bit = freecs_mask_bit(bit_idx);
                 type_info[info_count].size = size;
                 type_info[info_count].data = NULL;
                 type_info[info_count].type_index = bit_idx;
+                sources[info_count] = source;
                 info_count++;
             }
         }
@@ -283,33 +861,25 @@ freecs_entity_t* freecs_spawn_batch(freecs_world_t* world, uint64_t mask, size_t
     freecs_archetype_t* arch = &world->archetypes[arch_idx];
 
     size_t start_row = arch->entities_len;
-    ensure_capacity_entities(&arch->entities, &arch->entities_cap, start_row + count);
+    archetype_reserve(arch, start_row + count);
 
-    for (size_t c = 0; c < arch->columns_len; c++) {
-        freecs_component_column_t* col = &arch->columns[c];
-        ensure_capacity_u8(&col->data, &col->data_cap, col->data_len + count * col->elem_size);
+    for (size_t i = 0; i < info_count; i++) {
+        freecs_component_column_t* col = &arch->columns[arch->column_bits[type_info[i].type_index]];
+        fill_column_rows(arch, col, start_row, count, sources[i]);
     }
+    mark_new_rows(world, arch, start_row, count);
 
     freecs_entity_t* entities = malloc(count * sizeof(freecs_entity_t));
+    alloc_entities(world, entities, count);
+    memcpy(&arch->entities[start_row], entities, count * sizeof(freecs_entity_t));
+    arch->entities_len += count;
+    record_transition(world, FREECS_MASK_EMPTY, arch->mask, entities, count);
 
     for (size_t i = 0; i < count; i++) {
-        freecs_entity_t entity = alloc_entity(world);
-        entities[i] = entity;
-        size_t row = start_row + i;
-        arch->entities[arch->entities_len++] = entity;
-
-        for (size_t c = 0; c < arch->columns_len; c++) {
-            freecs_component_column_t* col = &arch->columns[c];
-            size_t old_len = col->data_len;
-            col->data_len = old_len + col->elem_size;
-            memset(&col->data[old_len], 0, col->elem_size);
-        }
-
-        world->locations[entity.id] = (freecs_entity_location_t){
-            .generation = entity.generation,
+        world->locations[entities[i].id] = (freecs_entity_location_t){
+            .generation = entities[i].generation,
             .archetype_index = (uint32_t)arch_idx,
-            .row = (uint32_t)row,
-            .alive = true
+            .row = (uint32_t)(start_row + i),
         };
     }
 
@@ -317,14 +887,21 @@ freecs_entity_t* freecs_spawn_batch(freecs_world_t* world, uint64_t mask, size_t
     return entities;
 }
 
-freecs_entity_t* freecs_spawn_with_init(freecs_world_t* world, uint64_t mask, size_t count, void (*init_callback)(freecs_archetype_t*, size_t), size_t* out_count) {
+freecs_entity_t* freecs_spawn_batch(freecs_world_t* world, freecs_mask_t mask, size_t count, size_t* out_count) {
+    return spawn_rows(world, mask, count, NULL, out_count);
+}
+
+freecs_entity_t* freecs_spawn_batch_columns(freecs_world_t* world, freecs_mask_t mask, size_t count, const void* const* column_sources, size_t* out_count) {
+    return spawn_rows(world, mask, count, column_sources, out_count);
+}
+
+freecs_entity_t* freecs_spawn_with_init(freecs_world_t* world, freecs_mask_t mask, size_t count, void (*init_callback)(freecs_archetype_t*, size_t), size_t* out_count) {
     freecs_entity_t* entities = freecs_spawn_batch(world, mask, count, out_count);
     if (entities == NULL || *out_count == 0) return entities;
 
-    size_t idx = cache_find(world->archetype_index, world->archetype_index_len, mask);
-    if (idx == (size_t)-1) return entities;
+    size_t arch_idx = archetype_index_find(world, mask);
+    if (arch_idx == (size_t)-1) return entities;
 
-    size_t arch_idx = world->archetype_index[idx].value.indices[0];
     freecs_archetype_t* arch = &world->archetypes[arch_idx];
     size_t start_row = arch->entities_len - count;
 
@@ -335,125 +912,152 @@ freecs_entity_t* freecs_spawn_with_init(freecs_world_t* world, uint64_t mask, si
     return entities;
 }
 
+static void release_entity(freecs_world_t* world, freecs_entity_t entity) {
+    freecs_entity_location_t* loc = &world->locations[entity.id];
+    uint32_t generation = (entity.generation + 1) & ~FREECS_GENERATION_DEAD;
+    loc->generation = generation | FREECS_GENERATION_DEAD;
+
+    ensure_capacity_entities(&world->free_entities, &world->free_entities_cap, world->free_entities_len + 1);
+    world->free_entities[world->free_entities_len++] = (freecs_entity_t){entity.id, generation};
+
+    if (world->tags != NULL) freecs_clear_entity_tags(world->tags, entity);
+}
+
 bool freecs_despawn(freecs_world_t* world, freecs_entity_t entity) {
     if (entity.id >= world->locations_len) return false;
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) return false;
+    if (!location_holds(loc, entity)) return false;
 
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
-    size_t row = loc->row;
-    size_t last_row = arch->entities_len - 1;
+    record_transition(world, arch->mask, FREECS_MASK_EMPTY, &entity, 1);
+    archetype_swap_remove(world, arch, loc->row);
+    release_entity(world, entity);
 
-    if (row < last_row) {
-        freecs_entity_t last_entity = arch->entities[last_row];
-        arch->entities[row] = last_entity;
-        world->locations[last_entity.id].row = (uint32_t)row;
+    return true;
+}
 
-        for (size_t c = 0; c < arch->columns_len; c++) {
-            freecs_component_column_t* col = &arch->columns[c];
-            if (col->elem_size > 0) {
-                size_t src_start = last_row * col->elem_size;
-                size_t dst_start = row * col->elem_size;
-                memcpy(&col->data[dst_start], &col->data[src_start], col->elem_size);
-            }
-        }
-    }
+size_t freecs_despawn_batch(freecs_world_t* world, const freecs_entity_t* entities, size_t count) {
+    if (count == 0) return 0;
 
-    arch->entities_len--;
-    for (size_t c = 0; c < arch->columns_len; c++) {
-        freecs_component_column_t* col = &arch->columns[c];
-        if (col->elem_size > 0) {
-            col->data_len -= col->elem_size;
-        }
-    }
+    size_t per_entity = 2 * sizeof(freecs_sort_item_t) + 2 * sizeof(size_t) + 1;
+    uint8_t* scratch_base = world_scratch(world, count * per_entity);
+    freecs_sort_item_t* victims = (freecs_sort_item_t*)scratch_base;
+    freecs_sort_item_t* sort_scratch = victims + count;
+    size_t* rows = (size_t*)(sort_scratch + count);
+    size_t* sources = rows + count;
+    uint8_t* marks = (uint8_t*)(sources + count);
 
-    loc->alive = false;
-    loc->generation++;
+    ensure_capacity_entities(&world->free_entities, &world->free_entities_cap, world->free_entities_len + count);
 
-    ensure_capacity_entities(&world->free_entities, &world->free_entities_cap, world->free_entities_len + 1);
-    world->free_entities[world->free_entities_len++] = (freecs_entity_t){entity.id, loc->generation};
+    size_t despawned = 0;
+    for (size_t i = 0; i < count; i++) {
+        freecs_entity_t entity = entities[i];
+        if (entity.id >= world->locations_len) continue;
 
-    return true;
-}
+        freecs_entity_location_t* loc = &world->locations[entity.id];
+        if (!location_holds(loc, entity)) continue;
 
-size_t freecs_despawn_batch(freecs_world_t* world, const freecs_entity_t* entities, size_t count) {
-    size_t despawned = 0;
-    for (size_t i = 0; i < count; i++) {
-        if (freecs_despawn(world, entities[i])) {
-            despawned++;
+        victims[despawned++] = (freecs_sort_item_t){(uint64_t)loc->archetype_index << 32 | loc->row, entity.id};
+        record_transition(world, world->archetypes[loc->archetype_index].mask, FREECS_MASK_EMPTY, &entity, 1);
+        release_entity(world, entity);
+    }
+
+    radix_sort_items(victims, sort_scratch, despawned);
+
+    size_t group_start = 0;
+    while (group_start < despawned) {
+        uint32_t arch_idx = (uint32_t)(victims[group_start].key >> 32);
+        size_t group_end = group_start;
+        while (group_end < despawned && (uint32_t)(victims[group_end].key >> 32) == arch_idx) {
+            rows[group_end - group_start] = (uint32_t)victims[group_end].key;
+            group_end++;
         }
+        archetype_remove_rows(world, &world->archetypes[arch_idx], rows, group_end - group_start, sources, marks);
+        group_start = group_end;
     }
+
     return despawned;
 }
 
 bool freecs_is_alive(freecs_world_t* world, freecs_entity_t entity) {
     if (entity.id >= world->locations_len) return false;
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    return loc->alive && loc->generation == entity.generation;
+    return location_holds(loc, entity);
 }
 
-void* freecs_get(freecs_world_t* world, freecs_entity_t entity, uint64_t bit) {
+void* freecs_get(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit) {
     if (entity.id >= world->locations_len) return NULL;
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) return NULL;
+    if (!location_holds(loc, entity)) return NULL;
 
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
     int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
     if (col_idx < 0) return NULL;
 
-    freecs_component_column_t* col = &arch->columns[col_idx];
-    size_t offset = loc->row * col->elem_size;
-    return &col->data[offset];
+    return column_row(arch, &arch->columns[col_idx], loc->row);
+}
+
+void* freecs_get_unchecked(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit) {
+    freecs_entity_location_t* loc = &world->locations[entity.id];
+    freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
+    int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
+    return column_row(arch, &arch->columns[col_idx], loc->row);
 }
 
-void* freecs_get_unchecked(freecs_world_t* world, freecs_entity_t entity, uint64_t bit) {
+void* freecs_get_mut(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit) {
+    if (entity.id >= world->locations_len) return NULL;
+
     freecs_entity_location_t* loc = &world->locations[entity.id];
+    if (!location_holds(loc, entity)) return NULL;
+
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
     int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
+    if (col_idx < 0) return NULL;
+
     freecs_component_column_t* col = &arch->columns[col_idx];
-    size_t offset = loc->row * col->elem_size;
-    return &col->data[offset];
+    touch_row(world, arch, col, loc->row);
+    return column_row(arch, col, loc->row);
 }
 
-bool freecs_set(freecs_world_t* world, freecs_entity_t entity, uint64_t bit, const void* value, size_t size) {
-    void* ptr = freecs_get(world, entity, bit);
+bool freecs_set(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit, const void* value, size_t size) {
+    void* ptr = freecs_get_mut(world, entity, bit);
     if (ptr == NULL) return false;
     memcpy(ptr, value, size);
     return true;
 }
 
-bool freecs_has(freecs_world_t* world, freecs_entity_t entity, uint64_t bit) {
+bool freecs_has(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit) {
     if (entity.id >= world->locations_len) return false;
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) return false;
+    if (!location_holds(loc, entity)) return false;
 
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
-    return (arch->mask & bit) != 0;
+    return freecs_mask_intersects(arch->mask, bit);
 }
 
-bool freecs_has_components(freecs_world_t* world, freecs_entity_t entity, uint64_t mask) {
+bool freecs_has_components(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t mask) {
     if (entity.id >= world->locations_len) return false;
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) return false;
+    if (!location_holds(loc, entity)) return false;
 
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
-    return (arch->mask & mask) == mask;
+    return freecs_mask_contains(arch->mask, mask);
 }
 
-uint64_t freecs_component_mask(freecs_world_t* world, freecs_entity_t entity, bool* ok) {
+freecs_mask_t freecs_component_mask(freecs_world_t* world, freecs_entity_t entity, bool* ok) {
     if (entity.id >= world->locations_len) {
         *ok = false;
-        return 0;
+        return FREECS_MASK_EMPTY;
     }
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) {
+    if (!location_holds(loc, entity)) {
         *ok = false;
-        return 0;
+        return FREECS_MASK_EMPTY;
     }
 
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
@@ -466,76 +1070,55 @@ static void move_entity(freecs_world_t* world, freecs_entity_t entity, size_t fr
     freecs_archetype_t* to_arch = &world->archetypes[to_arch_idx];
 
     size_t new_row = to_arch->entities_len;
-    ensure_capacity_entities(&to_arch->entities, &to_arch->entities_cap, new_row + 1);
+    archetype_reserve(to_arch, new_row + 1);
     to_arch->entities[to_arch->entities_len++] = entity;
 
     for (size_t c = 0; c < to_arch->columns_len; c++) {
         freecs_component_column_t* to_col = &to_arch->columns[c];
-        size_t old_len = to_col->data_len;
-        ensure_capacity_u8(&to_col->data, &to_col->data_cap, old_len + to_col->elem_size);
-        to_col->data_len = old_len + to_col->elem_size;
+        if (to_col->elem_size == 0) continue;
+        uint8_t* dst = column_row(to_arch, to_col, new_row);
 
         int32_t from_col_idx = from_arch->column_bits[freecs_bit_index(to_col->bit)];
         if (from_col_idx >= 0) {
             freecs_component_column_t* from_col = &from_arch->columns[from_col_idx];
-            size_t src_offset = from_row * from_col->elem_size;
-            memcpy(&to_col->data[old_len], &from_col->data[src_offset], to_col->elem_size);
-        } else {
-            memset(&to_col->data[old_len], 0, to_col->elem_size);
-        }
-    }
-
-    size_t last_row = from_arch->entities_len - 1;
-    if (from_row < last_row) {
-        freecs_entity_t last_entity = from_arch->entities[last_row];
-        from_arch->entities[from_row] = last_entity;
-        world->locations[last_entity.id].row = (uint32_t)from_row;
-
-        for (size_t c = 0; c < from_arch->columns_len; c++) {
-            freecs_component_column_t* col = &from_arch->columns[c];
-            if (col->elem_size > 0) {
-                size_t src_start = last_row * col->elem_size;
-                size_t dst_start = from_row * col->elem_size;
-                memcpy(&col->data[dst_start], &col->data[src_start], col->elem_size);
+            memcpy(dst, column_row(from_arch, from_col, from_row), to_col->elem_size);
+            if (to_col->tracked) {
+                set_row_tick(to_arch, to_col, new_row, from_col->tracked ? from_col->ticks[from_row] : world->change_tick);
             }
+        } else {
+            memset(dst, 0, to_col->elem_size);
+            touch_row(world, to_arch, to_col, new_row);
         }
     }
 
-    from_arch->entities_len--;
-    for (size_t c = 0; c < from_arch->columns_len; c++) {
-        freecs_component_column_t* col = &from_arch->columns[c];
-        if (col->elem_size > 0) {
-            col->data_len -= col->elem_size;
-        }
-    }
+    archetype_swap_remove(world, from_arch, from_row);
+    record_transition(world, from_arch->mask, to_arch->mask, &entity, 1);
 
     world->locations[entity.id] = (freecs_entity_location_t){
         .generation = entity.generation,
         .archetype_index = (uint32_t)to_arch_idx,
         .row = (uint32_t)new_row,
-        .alive = true
     };
 }
 
-bool freecs_add_component(freecs_world_t* world, freecs_entity_t entity, uint64_t bit, const void* value, size_t size) {
+bool freecs_add_component(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit, const void* value, size_t size) {
     if (entity.id >= world->locations_len) return false;
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) return false;
+    if (!location_holds(loc, entity)) return false;
 
     size_t bit_idx = freecs_bit_index(bit);
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
 
-    if ((arch->mask & bit) != 0) {
-        int32_t col_idx = arch->column_bits[bit_idx];
-        freecs_component_column_t* col = &arch->columns[col_idx];
-        size_t offset = loc->row * col->elem_size;
-        memcpy(&col->data[offset], value, size);
+    if (freecs_mask_intersects(arch->mask, bit)) {
+        freecs_component_column_t* col = &arch->columns[arch->column_bits[bit_idx]];
+        memcpy(column_row(arch, col, loc->row), value, size);
+        touch_row(world, arch, col, loc->row);
         return true;
     }
 
-    uint64_t new_mask = arch->mask | bit;
-    int32_t target_arch_idx_signed = arch->edges.add_edges[bit_idx];
+    freecs_mask_t new_mask = freecs_mask_or(arch->mask, bit);
+    int32_t target_arch_idx_signed = edge_get(&arch->edges, edge_key(bit_idx, false));
 
     if (target_arch_idx_signed < 0) {
         freecs_type_info_entry_t type_info[FREECS_MAX_COMPONENTS];
@@ -556,7 +1139,8 @@ bool freecs_add_component(freecs_world_t* world, freecs_entity_t entity, uint64_
         info_count++;
 
         target_arch_idx_signed = (int32_t)find_or_create_archetype(world, new_mask, type_info, info_count);
-        world->archetypes[loc->archetype_index].edges.add_edges[bit_idx] = target_arch_idx_signed;
+        edge_set(&world->archetypes[loc->archetype_index].edges, edge_key(bit_idx, false), target_arch_idx_signed);
+        edge_set(&world->archetypes[target_arch_idx_signed].edges, edge_key(bit_idx, true), (int32_t)loc->archetype_index);
     }
 
     size_t target_arch_idx = (size_t)target_arch_idx_signed;
@@ -566,33 +1150,31 @@ bool freecs_add_component(freecs_world_t* world, freecs_entity_t entity, uint64_
         freecs_entity_location_t* new_loc = &world->locations[entity.id];
         freecs_archetype_t* to_arch = &world->archetypes[new_loc->archetype_index];
         int32_t col_idx = to_arch->column_bits[bit_idx];
-        freecs_component_column_t* col = &to_arch->columns[col_idx];
-        size_t offset = new_loc->row * col->elem_size;
-        memcpy(&col->data[offset], value, size);
+        memcpy(column_row(to_arch, &to_arch->columns[col_idx], new_loc->row), value, size);
     }
 
     return true;
 }
 
-bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, uint64_t bit) {
+bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit) {
     if (entity.id >= world->locations_len) return false;
 
     freecs_entity_location_t* loc = &world->locations[entity.id];
-    if (!loc->alive || loc->generation != entity.generation) return false;
+    if (!location_holds(loc, entity)) return false;
 
     size_t bit_idx = freecs_bit_index(bit);
     freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
 
-    if ((arch->mask & bit) == 0) return false;
+    if (!freecs_mask_intersects(arch->mask, bit)) return false;
 
-    uint64_t new_mask = arch->mask & ~bit;
+    freecs_mask_t new_mask = freecs_mask_andnot(arch->mask, bit);
 
-    if (new_mask == 0) {
+    if (freecs_mask_is_empty(new_mask)) {
         freecs_despawn(world, entity);
         return true;
     }
 
-    int32_t target_arch_idx_signed = arch->edges.remove_edges[bit_idx];
+    int32_t target_arch_idx_signed = edge_get(&arch->edges, edge_key(bit_idx, true));
 
     if (target_arch_idx_signed < 0) {
         freecs_type_info_entry_t type_info[FREECS_MAX_COMPONENTS];
@@ -600,7 +1182,7 @@ bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, uint
 
         for (size_t c = 0; c < arch->columns_len; c++) {
             freecs_component_column_t* col = &arch->columns[c];
-            if (col->bit != bit) {
+            if (!freecs_mask_equal(col->bit, bit)) {
                 type_info[info_count].bit = col->bit;
                 type_info[info_count].size = col->elem_size;
                 type_info[info_count].data = NULL;
@@ -610,7 +1192,8 @@ bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, uint
         }
 
         target_arch_idx_signed = (int32_t)find_or_create_archetype(world, new_mask, type_info, info_count);
-        world->archetypes[loc->archetype_index].edges.remove_edges[bit_idx] = target_arch_idx_signed;
+        edge_set(&world->archetypes[loc->archetype_index].edges, edge_key(bit_idx, true), target_arch_idx_signed);
+        edge_set(&world->archetypes[target_arch_idx_signed].edges, edge_key(bit_idx, false), (int32_t)loc->archetype_index);
     }
 
     size_t target_arch_idx = (size_t)target_arch_idx_signed;
@@ -619,34 +1202,43 @@ bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, uint
     return true;
 }
 
-size_t* freecs_get_matching_archetypes(freecs_world_t* world, uint64_t mask, uint64_t exclude, size_t* out_count) {
-    uint64_t cache_key = mask | (exclude << 32);
-    size_t idx = cache_find(world->query_cache, world->query_cache_len, cache_key);
-    if (idx != (size_t)-1) {
-        *out_count = world->query_cache[idx].value.len;
-        return world->query_cache[idx].value.indices;
+static void query_cache_lock(freecs_world_t* world) {
+    while (atomic_flag_test_and_set_explicit(&world->query_lock, memory_order_acquire)) {
+    }
+}
+
+static void query_cache_unlock(freecs_world_t* world) {
+    atomic_flag_clear_explicit(&world->query_lock, memory_order_release);
+}
+
+size_t* freecs_get_matching_archetypes(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, size_t* out_count) {
+    query_cache_lock(world);
+    freecs_cache_entry_t* cached = query_cache_find(world, mask, exclude);
+    if (cached != NULL) {
+        *out_count = cached->value.len;
+        size_t* indices = cached->value.indices;
+        query_cache_unlock(world);
+        return indices;
     }
 
     freecs_index_array_t matching = {0};
 
     for (size_t i = 0; i < world->archetypes_len; i++) {
         freecs_archetype_t* arch = &world->archetypes[i];
-        if ((arch->mask & mask) == mask && (exclude == 0 || (arch->mask & exclude) == 0)) {
+        if (freecs_mask_contains(arch->mask, mask) && !freecs_mask_intersects(arch->mask, exclude)) {
             ensure_capacity_indices(&matching.indices, &matching.cap, matching.len + 1);
             matching.indices[matching.len++] = i;
         }
     }
 
-    ensure_capacity_cache(&world->query_cache, &world->query_cache_cap, world->query_cache_len + 1);
-    world->query_cache[world->query_cache_len].key = cache_key;
-    world->query_cache[world->query_cache_len].value = matching;
-    world->query_cache_len++;
+    query_cache_insert(world, mask, exclude, matching);
+    query_cache_unlock(world);
 
     *out_count = matching.len;
     return matching.indices;
 }
 
-size_t freecs_query_count(freecs_world_t* world, uint64_t mask, uint64_t exclude) {
+size_t freecs_query_count(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude) {
     size_t count = 0;
     size_t matching_count;
     size_t* matching = freecs_get_matching_archetypes(world, mask, exclude, &matching_count);
@@ -656,7 +1248,7 @@ size_t freecs_query_count(freecs_world_t* world, uint64_t mask, uint64_t exclude
     return count;
 }
 
-freecs_entity_t* freecs_query_entities(freecs_world_t* world, uint64_t mask, uint64_t exclude, size_t* out_count) {
+freecs_entity_t* freecs_query_entities(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, size_t* out_count) {
     size_t total = freecs_query_count(world, mask, exclude);
     if (total == 0) {
         *out_count = 0;
@@ -679,7 +1271,7 @@ freecs_entity_t* freecs_query_entities(freecs_world_t* world, uint64_t mask, uin
     return entities;
 }
 
-freecs_entity_t freecs_query_first(freecs_world_t* world, uint64_t mask, uint64_t exclude, bool* found) {
+freecs_entity_t freecs_query_first(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, bool* found) {
     size_t matching_count;
     size_t* matching = freecs_get_matching_archetypes(world, mask, exclude, &matching_count);
     for (size_t i = 0; i < matching_count; i++) {
@@ -701,7 +1293,8 @@ size_t freecs_entity_count(freecs_world_t* world) {
     return count;
 }
 
-void* freecs_column(freecs_archetype_t* arch, uint64_t bit, size_t* out_count) {
+#ifndef FREECS_CHUNKED_STORAGE
+void* freecs_column(freecs_archetype_t* arch, freecs_mask_t bit, size_t* out_count) {
     int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
     if (col_idx < 0) {
         *out_count = 0;
@@ -710,20 +1303,29 @@ void* freecs_column(freecs_archetype_t* arch, uint64_t bit, size_t* out_count) {
 
     freecs_component_column_t* col = &arch->columns[col_idx];
     *out_count = arch->entities_len;
-    if (arch->entities_len == 0 || col->data_len == 0) {
+    if (arch->entities_len == 0 || col->elem_size == 0) {
         return NULL;
     }
 
-    return col->data;
+    return column_row(arch, col, 0);
 }
 
-void* freecs_column_unchecked(freecs_archetype_t* arch, uint64_t bit) {
-    if (bit == 0) return NULL;
+void* freecs_column_unchecked(freecs_archetype_t* arch, freecs_mask_t bit) {
+    if (freecs_mask_is_empty(bit)) return NULL;
     int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
     if (col_idx < 0 || (size_t)col_idx >= arch->columns_len) return NULL;
     return arch->columns[col_idx].data;
 }
-freecs_table_iterator_t freecs_table_iterator(freecs_world_t* world, uint64_t mask, uint64_t exclude) {
+#endif
+
+void* freecs_column_row(freecs_archetype_t* arch, freecs_mask_t bit, size_t row) {
+    if (freecs_mask_is_empty(bit) || row >= arch->entities_len) return NULL;
+    int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
+    if (col_idx < 0) return NULL;
+    return column_row(arch, &arch->columns[col_idx], row);
+}
+
+freecs_table_iterator_t freecs_table_iterator(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude) {
     size_t count;
     size_t* indices = freecs_get_matching_archetypes(world, mask, exclude, &count);
     return (freecs_table_iterator_t){
@@ -732,19 +1334,242 @@ freecs_table_iterator_t freecs_table_iterator(freecs_world_t* world, uint64_t ma
         .exclude = exclude,
         .indices = indices,
         .indices_len = count,
-        .current = 0
+        .current = 0,
+        .row = 0
     };
 }
 
+static size_t changed_columns(const freecs_archetype_t* arch, freecs_mask_t changed, const freecs_component_column_t** out) {
+    size_t count = 0;
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        if (arch->columns[c].tracked && freecs_mask_intersects(changed, arch->columns[c].bit)) {
+            out[count++] = &arch->columns[c];
+        }
+    }
+    return count;
+}
+
+static inline bool row_changed(const freecs_component_column_t* const* cols, size_t count, size_t row, uint32_t since_tick) {
+    for (size_t i = 0; i < count; i++) {
+        if (cols[i]->ticks[row] >= since_tick) return true;
+    }
+    return false;
+}
+
+static size_t scan_rows(const freecs_component_column_t* const* cols, size_t count, size_t row, size_t end, uint32_t since_tick, bool changed) {
+    if (count == 1) {
+        const uint32_t* ticks = cols[0]->ticks;
+        if (changed) {
+            while (row < end && ticks[row] >= since_tick) row++;
+        } else {
+            while (row < end && ticks[row] < since_tick) row++;
+        }
+        return row;
+    }
+    while (row < end && row_changed(cols, count, row, since_tick) == changed) row++;
+    return row;
+}
+
+static inline bool block_changed(const freecs_component_column_t* const* cols, size_t count, size_t block, uint32_t since_tick) {
+    for (size_t i = 0; i < count; i++) {
+        if (cols[i]->block_ticks[block] >= since_tick) return true;
+    }
+    return false;
+}
+
+static bool next_changed_rows(freecs_table_iterator_t* iter, freecs_table_iterator_result_t* result) {
+    const freecs_component_column_t* cols[FREECS_MAX_COMPONENTS];
+    while (iter->current < iter->indices_len) {
+        size_t arch_idx = iter->indices[iter->current];
+        freecs_archetype_t* arch = &iter->world->archetypes[arch_idx];
+        size_t count = changed_columns(arch, iter->changed, cols);
+        size_t len = count == 0 ? 0 : arch->entities_len;
+        size_t row = iter->row;
+
+        while (row < len) {
+            size_t block = row >> arch->change_shift;
+            size_t block_end = (block + 1) << arch->change_shift;
+            if (block_end > len) block_end = len;
+            if (!block_changed(cols, count, block, iter->since_tick)) {
+                row = block_end;
+                continue;
+            }
+            row = scan_rows(cols, count, row, block_end, iter->since_tick, false);
+            if (row < block_end) break;
+        }
+
+        if (row >= len) {
+            iter->current++;
+            iter->row = 0;
+            continue;
+        }
+
+        size_t end = len;
+#ifdef FREECS_CHUNKED_STORAGE
+        size_t chunk_end = ((row >> arch->chunk_shift) + 1) << arch->chunk_shift;
+        if (chunk_end < end) end = chunk_end;
+#endif
+        size_t run_end = scan_rows(cols, count, row + 1, end, iter->since_tick, true);
+
+        iter->row = run_end;
+        result->archetype = arch;
+        result->index = arch_idx;
+        result->row_start = row;
+        result->row_count = run_end - row;
+        return true;
+    }
+    return false;
+}
+
 bool freecs_table_iterator_next(freecs_table_iterator_t* iter, freecs_table_iterator_result_t* result) {
-    if (iter->current >= iter->indices_len) return false;
-    size_t arch_idx = iter->indices[iter->current++];
-    result->archetype = &iter->world->archetypes[arch_idx];
-    result->index = arch_idx;
-    return true;
+    if (!freecs_mask_is_empty(iter->changed)) return next_changed_rows(iter, result);
+    while (iter->current < iter->indices_len) {
+        size_t arch_idx = iter->indices[iter->current];
+        freecs_archetype_t* arch = &iter->world->archetypes[arch_idx];
+#ifdef FREECS_CHUNKED_STORAGE
+        if (iter->row >= arch->entities_len) {
+            iter->current++;
+            iter->row = 0;
+            continue;
+        }
+        size_t row_count = arch->entities_len - iter->row;
+        if (row_count > arch->chunk_rows) row_count = arch->chunk_rows;
+        result->row_start = iter->row;
+        iter->row += row_count;
+#else
+        size_t row_count = arch->entities_len;
+        result->row_start = 0;
+        iter->current++;
+#endif
+        result->archetype = arch;
+        result->index = arch_idx;
+        result->row_count = row_count;
+        return true;
+    }
+    return false;
+}
+
+void* freecs_iter_column(const freecs_table_iterator_result_t* result, freecs_mask_t bit) {
+    if (freecs_mask_is_empty(bit) || result->row_count == 0) return NULL;
+    freecs_archetype_t* arch = result->archetype;
+    int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
+    if (col_idx < 0) return NULL;
+    return column_row(arch, &arch->columns[col_idx], result->row_start);
+}
+
+void* freecs_iter_column_mut(freecs_world_t* world, const freecs_table_iterator_result_t* result, freecs_mask_t bit) {
+    if (freecs_mask_is_empty(bit) || result->row_count == 0) return NULL;
+    freecs_archetype_t* arch = result->archetype;
+    int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
+    if (col_idx < 0) return NULL;
+    freecs_component_column_t* col = &arch->columns[col_idx];
+    if (col->tracked) mark_rows(arch, col, result->row_start, result->row_count, world->change_tick);
+    return column_row(arch, col, result->row_start);
+}
+
+void freecs_track_changes(freecs_world_t* world, freecs_mask_t mask) {
+    world->tracked = freecs_mask_or(world->tracked, mask);
+    for (size_t i = 0; i < world->archetypes_len; i++) {
+        freecs_archetype_t* arch = &world->archetypes[i];
+        for (size_t c = 0; c < arch->columns_len; c++) {
+            freecs_component_column_t* col = &arch->columns[c];
+            if (col->tracked || col->elem_size == 0 || !freecs_mask_intersects(mask, col->bit)) continue;
+            col->tracked = true;
+            arch->tracked = true;
+            reserve_column_ticks(arch, col, arch->entities_cap);
+            mark_rows(arch, col, 0, arch->entities_len, world->change_tick);
+        }
+    }
+}
+
+uint32_t freecs_change_tick(freecs_world_t* world) {
+    return world->change_tick;
+}
+
+uint32_t freecs_advance_tick(freecs_world_t* world) {
+    return ++world->change_tick;
+}
+
+void freecs_mark_changed(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit) {
+    freecs_get_mut(world, entity, bit);
+}
+
+bool freecs_changed_since(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit, uint32_t since_tick) {
+    if (entity.id >= world->locations_len) return false;
+
+    freecs_entity_location_t* loc = &world->locations[entity.id];
+    if (!location_holds(loc, entity)) return false;
+
+    freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
+    int32_t col_idx = arch->column_bits[freecs_bit_index(bit)];
+    if (col_idx < 0) return false;
+
+    const freecs_component_column_t* col = &arch->columns[col_idx];
+    return col->tracked && col->ticks[loc->row] >= since_tick;
+}
+
+freecs_table_iterator_t freecs_query_changed(freecs_world_t* world, freecs_mask_t mask, uint32_t since_tick) {
+    freecs_table_iterator_t iter = freecs_table_iterator(world, mask, FREECS_MASK_EMPTY);
+    iter.changed = mask;
+    iter.since_tick = since_tick;
+    return iter;
+}
+
+void freecs_observe_components(freecs_world_t* world, freecs_mask_t mask) {
+    if (world->component_events == NULL) {
+        world->component_events = calloc(FREECS_MAX_COMPONENTS, sizeof(freecs_component_events_t));
+    }
+    world->observed = freecs_mask_or(world->observed, mask);
+}
+
+const freecs_entity_t* freecs_added(freecs_world_t* world, freecs_mask_t bit, size_t* out_count) {
+    if (world->component_events == NULL || freecs_mask_is_empty(bit)) {
+        *out_count = 0;
+        return NULL;
+    }
+    freecs_component_events_t* events = &world->component_events[freecs_bit_index(bit)];
+    *out_count = events->added_len;
+    return events->added;
+}
+
+const freecs_entity_t* freecs_removed(freecs_world_t* world, freecs_mask_t bit, size_t* out_count) {
+    if (world->component_events == NULL || freecs_mask_is_empty(bit)) {
+        *out_count = 0;
+        return NULL;
+    }
+    freecs_component_events_t* events = &world->component_events[freecs_bit_index(bit)];
+    *out_count = events->removed_len;
+    return events->removed;
+}
+
+freecs_entity_t* freecs_query_added(freecs_world_t* world, freecs_mask_t bit, freecs_mask_t mask, freecs_mask_t exclude, size_t* out_count) {
+    size_t added_count;
+    const freecs_entity_t* added = freecs_added(world, bit, &added_count);
+    *out_count = 0;
+    if (added_count == 0) return NULL;
+
+    freecs_mask_t include = freecs_mask_or(mask, bit);
+    freecs_entity_t* result = malloc(added_count * sizeof(freecs_entity_t));
+    for (size_t i = 0; i < added_count; i++) {
+        if (!freecs_is_alive(world, added[i])) continue;
+        const freecs_archetype_t* arch = &world->archetypes[world->locations[added[i].id].archetype_index];
+        if (freecs_mask_contains(arch->mask, include) && !freecs_mask_intersects(arch->mask, exclude)) {
+            result[(*out_count)++] = added[i];
+        }
+    }
+    return result;
+}
+
+void freecs_clear_component_events(freecs_world_t* world) {
+    if (world->component_events == NULL) return;
+    for (size_t i = 0; i < world->next_component; i++) {
+        world->component_events[i].added_len = 0;
+        world->component_events[i].removed_base += world->component_events[i].removed_len;
+        world->component_events[i].removed_len = 0;
+    }
 }
 
-void freecs_for_each(freecs_world_t* world, uint64_t mask, uint64_t exclude, void (*callback)(freecs_archetype_t*, size_t)) {
+void freecs_for_each(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, void (*callback)(freecs_archetype_t*, size_t)) {
     size_t matching_count;
     size_t* matching = freecs_get_matching_archetypes(world, mask, exclude, &matching_count);
     for (size_t i = 0; i < matching_count; i++) {
@@ -755,7 +1580,7 @@ void freecs_for_each(freecs_world_t* world, uint64_t mask, uint64_t exclude, voi
     }
 }
 
-void freecs_for_each_table(freecs_world_t* world, uint64_t mask, uint64_t exclude, void (*callback)(freecs_archetype_t*)) {
+void freecs_for_each_table(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, void (*callback)(freecs_archetype_t*)) {
     size_t matching_count;
     size_t* matching = freecs_get_matching_archetypes(world, mask, exclude, &matching_count);
     for (size_t i = 0; i < matching_count; i++) {
@@ -763,15 +1588,267 @@ void freecs_for_each_table(freecs_world_t* world, uint64_t mask, uint64_t exclud
     }
 }
 
+typedef struct {
+    _Alignas(64) atomic_size_t next;
+    size_t end;
+} freecs_worker_range_t;
+
+typedef struct {
+    freecs_thread_pool_t* pool;
+    size_t thread_index;
+} freecs_worker_t;
+
+typedef void (*freecs_pool_task_fn)(size_t task, size_t thread_index, void* ctx);
+
+struct freecs_thread_pool_t {
+    pthread_t* threads;
+    freecs_worker_t* workers;
+    freecs_worker_range_t* ranges;
+    size_t thread_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    uint64_t generation;
+    size_t active;
+    bool shutdown;
+    atomic_flag busy;
+
+    freecs_pool_task_fn job;
+    void* job_ctx;
+
+    freecs_table_iterator_result_t* tasks;
+    size_t tasks_len;
+    size_t tasks_cap;
+};
+
+static _Thread_local size_t current_thread_index;
+
+static bool claim_task(freecs_worker_range_t* range, size_t* task) {
+    if (atomic_load_explicit(&range->next, memory_order_relaxed) >= range->end) return false;
+    size_t claimed = atomic_fetch_add_explicit(&range->next, 1, memory_order_relaxed);
+    if (claimed >= range->end) return false;
+    *task = claimed;
+    return true;
+}
+
+static void run_tasks(freecs_thread_pool_t* pool, size_t thread_index) {
+    size_t task;
+    while (claim_task(&pool->ranges[thread_index], &task)) {
+        pool->job(task, thread_index, pool->job_ctx);
+    }
+
+    for (size_t offset = 1; offset < pool->thread_count; offset++) {
+        freecs_worker_range_t* victim = &pool->ranges[(thread_index + offset) % pool->thread_count];
+        while (claim_task(victim, &task)) {
+            pool->job(task, thread_index, pool->job_ctx);
+        }
+    }
+}
+
+static void* worker_main(void* arg) {
+    freecs_worker_t* worker = arg;
+    freecs_thread_pool_t* pool = worker->pool;
+    uint64_t seen = 0;
+    current_thread_index = worker->thread_index;
+
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_cond, &pool->mutex);
+        }
+        if (pool->shutdown) {
+            pthread_mutex_unlock(&pool->mutex);
+            return NULL;
+        }
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->mutex);
+
+        run_tasks(pool, worker->thread_index);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->active == 0) {
+            pthread_cond_signal(&pool->done_cond);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+freecs_thread_pool_t* freecs_create_thread_pool(size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+
+    freecs_thread_pool_t* pool = calloc(1, sizeof(freecs_thread_pool_t));
+    pool->thread_count = thread_count;
+    pool->ranges = (freecs_worker_range_t*)aligned_alloc_block(_Alignof(freecs_worker_range_t), thread_count * sizeof(freecs_worker_range_t));
+    for (size_t i = 0; i < thread_count; i++) {
+        atomic_init(&pool->ranges[i].next, 0);
+        pool->ranges[i].end = 0;
+    }
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->work_cond, NULL);
+    pthread_cond_init(&pool->done_cond, NULL);
+    atomic_flag_clear(&pool->busy);
+
+    pool->threads = malloc(thread_count * sizeof(pthread_t));
+    pool->workers = malloc(thread_count * sizeof(freecs_worker_t));
+    for (size_t i = 1; i < thread_count; i++) {
+        pool->workers[i] = (freecs_worker_t){pool, i};
+        pthread_create(&pool->threads[i], NULL, worker_main, &pool->workers[i]);
+    }
+
+    return pool;
+}
+
+void freecs_destroy_thread_pool(freecs_thread_pool_t* pool) {
+    if (pool == NULL) return;
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    for (size_t i = 1; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->work_cond);
+    pthread_cond_destroy(&pool->done_cond);
+    aligned_free_block((uint8_t*)pool->ranges);
+    free(pool->threads);
+    free(pool->workers);
+    free(pool->tasks);
+    free(pool);
+}
+
+size_t freecs_thread_pool_size(const freecs_thread_pool_t* pool) {
+    return pool->thread_count;
+}
+
+static bool pool_acquire(freecs_thread_pool_t* pool) {
+    return !atomic_flag_test_and_set_explicit(&pool->busy, memory_order_acquire);
+}
+
+static void pool_release(freecs_thread_pool_t* pool) {
+    atomic_flag_clear_explicit(&pool->busy, memory_order_release);
+}
+
+static void pool_run(freecs_thread_pool_t* pool, size_t task_count, freecs_pool_task_fn job, void* ctx) {
+    if (task_count == 0) return;
+
+    pool->job = job;
+    pool->job_ctx = ctx;
+
+    size_t participants = task_count < pool->thread_count ? task_count : pool->thread_count;
+    size_t per_worker = task_count / participants;
+    size_t remainder = task_count % participants;
+    size_t begin = 0;
+    for (size_t i = 0; i < pool->thread_count; i++) {
+        size_t len = i < participants ? per_worker + (i < remainder ? 1 : 0) : 0;
+        atomic_store_explicit(&pool->ranges[i].next, begin, memory_order_relaxed);
+        pool->ranges[i].end = begin + len;
+        begin += len;
+    }
+
+    if (participants == 1) {
+        run_tasks(pool, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->active = pool->thread_count - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_cond);
+    pthread_mutex_unlock(&pool->mutex);
+
+    run_tasks(pool, 0);
+
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->active > 0) {
+        pthread_cond_wait(&pool->done_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+typedef struct {
+    const freecs_table_iterator_result_t* views;
+    freecs_par_table_fn callback;
+    void* user;
+} freecs_par_table_ctx_t;
+
+static void par_table_task(size_t task, size_t thread_index, void* ctx) {
+    freecs_par_table_ctx_t* table_ctx = ctx;
+    table_ctx->callback(&table_ctx->views[task], thread_index, table_ctx->user);
+}
+
+static void for_each_batch(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, freecs_par_table_fn callback, void* user) {
+    freecs_table_iterator_t iter = freecs_table_iterator(world, mask, exclude);
+    freecs_table_iterator_result_t view;
+    while (freecs_table_iterator_next(&iter, &view)) {
+        size_t end = view.row_start + view.row_count;
+        for (size_t start = view.row_start; start < end; start += FREECS_PAR_BATCH_ROWS) {
+            freecs_table_iterator_result_t batch = view;
+            batch.row_start = start;
+            batch.row_count = end - start < FREECS_PAR_BATCH_ROWS ? end - start : FREECS_PAR_BATCH_ROWS;
+            callback(&batch, current_thread_index, user);
+        }
+    }
+}
+
+void freecs_par_for_each_table(freecs_thread_pool_t* pool, freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, freecs_par_table_fn callback, void* user) {
+    if (!pool_acquire(pool)) {
+        for_each_batch(world, mask, exclude, callback, user);
+        return;
+    }
+
+    pool->tasks_len = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(world, mask, exclude);
+    freecs_table_iterator_result_t span;
+    while (freecs_table_iterator_next(&iter, &span)) {
+        for (size_t start = 0; start < span.row_count; start += FREECS_PAR_BATCH_ROWS) {
+            size_t count = span.row_count - start;
+            if (count > FREECS_PAR_BATCH_ROWS) count = FREECS_PAR_BATCH_ROWS;
+            ensure_capacity_views(&pool->tasks, &pool->tasks_cap, pool->tasks_len + 1);
+            pool->tasks[pool->tasks_len++] = (freecs_table_iterator_result_t){
+                .archetype = span.archetype,
+                .index = span.index,
+                .row_start = span.row_start + start,
+                .row_count = count
+            };
+        }
+    }
+
+    freecs_par_table_ctx_t ctx = {pool->tasks, callback, user};
+    pool_run(pool, pool->tasks_len, par_table_task, &ctx);
+    pool_release(pool);
+}
+
+typedef struct {
+    freecs_par_row_fn callback;
+    void* user;
+} freecs_par_row_ctx_t;
+
+static void par_row_trampoline(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    freecs_par_row_ctx_t* ctx = user;
+    size_t end = view->row_start + view->row_count;
+    for (size_t row = view->row_start; row < end; row++) {
+        ctx->callback(view->archetype, row, thread_index, ctx->user);
+    }
+}
+
+void freecs_par_for_each(freecs_thread_pool_t* pool, freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, freecs_par_row_fn callback, void* user) {
+    freecs_par_row_ctx_t ctx = {callback, user};
+    freecs_par_for_each_table(pool, world, mask, exclude, par_row_trampoline, &ctx);
+}
+
 void freecs_queue_despawn(freecs_world_t* world, freecs_entity_t entity) {
     ensure_capacity_entities(&world->despawn_queue, &world->despawn_queue_cap, world->despawn_queue_len + 1);
     world->despawn_queue[world->despawn_queue_len++] = entity;
 }
 
 void freecs_apply_despawns(freecs_world_t* world) {
-    for (size_t i = 0; i < world->despawn_queue_len; i++) {
-        freecs_despawn(world, world->despawn_queue[i]);
-    }
+    freecs_despawn_batch(world, world->despawn_queue, world->despawn_queue_len);
     world->despawn_queue_len = 0;
 }
 
@@ -780,62 +1857,62 @@ freecs_command_buffer_t freecs_create_command_buffer(freecs_world_t* world) {
         .commands = NULL,
         .commands_len = 0,
         .commands_cap = 0,
+        .arena = NULL,
+        .arena_len = 0,
+        .arena_cap = 0,
         .world = world
     };
 }
 
 void freecs_destroy_command_buffer(freecs_command_buffer_t* buffer) {
-    for (size_t i = 0; i < buffer->commands_len; i++) {
-        free(buffer->commands[i].component_data);
-        free(buffer->commands[i].component_sizes);
-        free(buffer->commands[i].component_bits);
-    }
     free(buffer->commands);
+    free(buffer->arena);
     memset(buffer, 0, sizeof(*buffer));
 }
 
 void freecs_clear_command_buffer(freecs_command_buffer_t* buffer) {
-    for (size_t i = 0; i < buffer->commands_len; i++) {
-        free(buffer->commands[i].component_data);
-        free(buffer->commands[i].component_sizes);
-        free(buffer->commands[i].component_bits);
-    }
     buffer->commands_len = 0;
+    buffer->arena_len = 0;
 }
 
-void freecs_queue_spawn(freecs_command_buffer_t* buffer, uint64_t mask, const freecs_type_info_entry_t* entries, size_t entry_count) {
-    ensure_capacity_commands(&buffer->commands, &buffer->commands_cap, buffer->commands_len + 1);
-
-    freecs_command_t* cmd = &buffer->commands[buffer->commands_len++];
-    memset(cmd, 0, sizeof(*cmd));
-    cmd->command_type = FREECS_CMD_SPAWN;
-    cmd->mask = mask;
+static inline const freecs_command_component_t* command_components(const freecs_command_buffer_t* buffer, const freecs_command_t* cmd) {
+    return (const freecs_command_component_t*)(buffer->arena + cmd->components_offset);
+}
 
-    size_t total_size = 0;
+static void record_components(freecs_command_buffer_t* buffer, freecs_command_t* cmd, const freecs_type_info_entry_t* entries, size_t entry_count) {
+    size_t data_size = 0;
     for (size_t i = 0; i < entry_count; i++) {
-        total_size += entries[i].size;
-    }
-
-    if (total_size > 0) {
-        cmd->component_data = malloc(total_size);
-        cmd->component_data_cap = total_size;
+        data_size += entries[i].size;
     }
 
-    cmd->component_sizes = malloc(entry_count * sizeof(size_t));
-    cmd->component_bits = malloc(entry_count * sizeof(uint64_t));
+    size_t header = align_up(buffer->arena_len, _Alignof(freecs_command_component_t));
+    size_t offset = header + entry_count * sizeof(freecs_command_component_t);
+    ensure_capacity_u8(&buffer->arena, &buffer->arena_cap, offset + data_size);
 
-    size_t offset = 0;
+    freecs_command_component_t* components = (freecs_command_component_t*)(buffer->arena + header);
     for (size_t i = 0; i < entry_count; i++) {
-        cmd->component_bits[i] = entries[i].bit;
-        cmd->component_sizes[i] = entries[i].size;
-        if (entries[i].data && entries[i].size > 0) {
-            memcpy(&cmd->component_data[offset], entries[i].data, entries[i].size);
+        components[i] = (freecs_command_component_t){entries[i].bit, entries[i].size, offset};
+        if (entries[i].data != NULL && entries[i].size > 0) {
+            memcpy(&buffer->arena[offset], entries[i].data, entries[i].size);
+        } else {
+            memset(&buffer->arena[offset], 0, entries[i].size);
         }
         offset += entries[i].size;
     }
-    cmd->component_data_len = offset;
-    cmd->component_sizes_len = entry_count;
-    cmd->component_bits_len = entry_count;
+
+    buffer->arena_len = offset;
+    cmd->components_offset = header;
+    cmd->components_len = entry_count;
+}
+
+void freecs_queue_spawn(freecs_command_buffer_t* buffer, freecs_mask_t mask, const freecs_type_info_entry_t* entries, size_t entry_count) {
+    ensure_capacity_commands(&buffer->commands, &buffer->commands_cap, buffer->commands_len + 1);
+
+    freecs_command_t* cmd = &buffer->commands[buffer->commands_len++];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->command_type = FREECS_CMD_SPAWN;
+    cmd->mask = mask;
+    record_components(buffer, cmd, entries, entry_count);
 }
 
 void freecs_cmd_queue_despawn(freecs_command_buffer_t* buffer, freecs_entity_t entity) {
@@ -847,7 +1924,17 @@ void freecs_cmd_queue_despawn(freecs_command_buffer_t* buffer, freecs_entity_t e
     cmd->entity = entity;
 }
 
-void freecs_queue_add_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, uint64_t mask) {
+void freecs_queue_add_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, freecs_mask_t mask) {
+    ensure_capacity_commands(&buffer->commands, &buffer->commands_cap, buffer->commands_len + 1);
+
+    freecs_command_t* cmd = &buffer->commands[buffer->commands_len++];
+    memset(cmd, 0, sizeof(*cmd));
+    cmd->command_type = FREECS_CMD_ADD_COMPONENTS;
+    cmd->entity = entity;
+    cmd->mask = mask;
+}
+
+void freecs_queue_add_components_with_data(freecs_command_buffer_t* buffer, freecs_entity_t entity, freecs_mask_t mask, const freecs_type_info_entry_t* entries, size_t entry_count) {
     ensure_capacity_commands(&buffer->commands, &buffer->commands_cap, buffer->commands_len + 1);
 
     freecs_command_t* cmd = &buffer->commands[buffer->commands_len++];
@@ -855,9 +1942,10 @@ void freecs_queue_add_components(freecs_command_buffer_t* buffer, freecs_entity_
     cmd->command_type = FREECS_CMD_ADD_COMPONENTS;
     cmd->entity = entity;
     cmd->mask = mask;
+    record_components(buffer, cmd, entries, entry_count);
 }
 
-void freecs_queue_remove_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, uint64_t mask) {
+void freecs_queue_remove_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, freecs_mask_t mask) {
     ensure_capacity_commands(&buffer->commands, &buffer->commands_cap, buffer->commands_len + 1);
 
     freecs_command_t* cmd = &buffer->commands[buffer->commands_len++];
@@ -867,45 +1955,807 @@ void freecs_queue_remove_components(freecs_command_buffer_t* buffer, freecs_enti
     cmd->mask = mask;
 }
 
-void freecs_apply_commands(freecs_command_buffer_t* buffer) {
-    for (size_t i = 0; i < buffer->commands_len; i++) {
-        freecs_command_t* cmd = &buffer->commands[i];
+typedef struct {
+    freecs_entity_t entity;
+    uint32_t src;
+    uint32_t dst;
+    uint32_t row;
+    uint32_t first;
+    uint32_t count;
+} freecs_migration_t;
 
-        switch (cmd->command_type) {
-            case FREECS_CMD_SPAWN: {
-                freecs_type_info_entry_t entries[FREECS_MAX_COMPONENTS];
-                size_t offset = 0;
-                for (size_t j = 0; j < cmd->component_bits_len; j++) {
-                    entries[j].bit = cmd->component_bits[j];
-                    entries[j].size = cmd->component_sizes[j];
-                    entries[j].data = cmd->component_sizes[j] > 0 ? &cmd->component_data[offset] : NULL;
-                    entries[j].type_index = freecs_bit_index(cmd->component_bits[j]);
-                    offset += cmd->component_sizes[j];
-                }
-                freecs_spawn(buffer->world, cmd->mask, entries, cmd->component_bits_len);
-                break;
-            }
-            case FREECS_CMD_DESPAWN:
-                freecs_despawn(buffer->world, cmd->entity);
-                break;
-            case FREECS_CMD_ADD_COMPONENTS:
-            case FREECS_CMD_REMOVE_COMPONENTS:
-                break;
+#define FREECS_MIGRATE_DESPAWN UINT32_MAX
+
+static const uint8_t* command_payload(const freecs_command_buffer_t* buffer, const freecs_command_t* cmd, freecs_mask_t bit) {
+    const freecs_command_component_t* components = command_components(buffer, cmd);
+    for (size_t j = 0; j < cmd->components_len; j++) {
+        if (freecs_mask_equal(components[j].bit, bit)) {
+            return components[j].size > 0 ? &buffer->arena[components[j].data_offset] : NULL;
         }
     }
-
-    freecs_clear_command_buffer(buffer);
+    return NULL;
 }
 
-freecs_tags_t freecs_create_tags(void) {
-    freecs_tags_t tags = {0};
-    return tags;
+static const uint8_t* resolve_component(const freecs_command_buffer_t* buffer, const freecs_sort_item_t* refs, const freecs_migration_t* migration, freecs_mask_t bit, bool* keep) {
+    for (size_t k = migration->count; k-- > 0;) {
+        const freecs_command_t* cmd = &buffer->commands[refs[migration->first + k].value];
+        if (!freecs_mask_intersects(cmd->mask, bit)) continue;
+        if (cmd->command_type == FREECS_CMD_REMOVE_COMPONENTS) {
+            *keep = false;
+            return NULL;
+        }
+        const uint8_t* payload = command_payload(buffer, cmd, bit);
+        if (payload != NULL) {
+            *keep = false;
+            return payload;
+        }
+    }
+    *keep = true;
+    return NULL;
 }
 
-void freecs_destroy_tags(freecs_tags_t* tags) {
-    for (int i = 0; i < FREECS_MAX_TAGS; i++) {
-        free(tags->storage[i].entries);
+static size_t resolve_archetype(freecs_world_t* world, freecs_mask_t mask) {
+    size_t arch_idx = archetype_index_find(world, mask);
+    if (arch_idx != (size_t)-1) return arch_idx;
+
+    freecs_type_info_entry_t type_info[FREECS_MAX_COMPONENTS];
+    size_t info_count = 0;
+    for (size_t bit_idx = 0; bit_idx < FREECS_MAX_COMPONENTS; bit_idx++) {
+        if (freecs_mask_test(mask, bit_idx)) {
+            type_info[info_count++] = (freecs_type_info_entry_t){freecs_mask_bit(bit_idx), world->type_sizes[bit_idx], NULL, bit_idx};
+        }
+    }
+    return find_or_create_archetype(world, mask, type_info, info_count);
+}
+
+static void write_in_place(freecs_world_t* world, const freecs_command_buffer_t* buffer, const freecs_sort_item_t* refs, const freecs_migration_t* migration) {
+    freecs_archetype_t* arch = &world->archetypes[migration->src];
+    for (size_t c = 0; c < arch->columns_len; c++) {
+        freecs_component_column_t* col = &arch->columns[c];
+        if (col->elem_size == 0) continue;
+        bool keep;
+        const uint8_t* payload = resolve_component(buffer, refs, migration, col->bit, &keep);
+        if (payload != NULL) {
+            memcpy(column_row(arch, col, migration->row), payload, col->elem_size);
+        } else if (!keep) {
+            memset(column_row(arch, col, migration->row), 0, col->elem_size);
+        }
+        if (!keep) touch_row(world, arch, col, migration->row);
+    }
+}
+
+static void migrate_rows(freecs_world_t* world, const freecs_command_buffer_t* buffer, const freecs_sort_item_t* refs, const freecs_migration_t* migrations, const freecs_sort_item_t* order, size_t count) {
+    freecs_archetype_t* src = &world->archetypes[migrations[order[0].value].src];
+    freecs_archetype_t* dst = &world->archetypes[migrations[order[0].value].dst];
+    uint32_t dst_idx = migrations[order[0].value].dst;
+    size_t base = dst->entities_len;
+    archetype_reserve(dst, base + count);
+
+    for (size_t c = 0; c < dst->columns_len; c++) {
+        freecs_component_column_t* col = &dst->columns[c];
+        if (col->elem_size == 0) continue;
+        int32_t src_col_idx = src->column_bits[freecs_bit_index(col->bit)];
+        freecs_component_column_t* src_col = src_col_idx >= 0 ? &src->columns[src_col_idx] : NULL;
+        for (size_t k = 0; k < count; k++) {
+            const freecs_migration_t* migration = &migrations[order[k].value];
+            bool keep;
+            const uint8_t* payload = resolve_component(buffer, refs, migration, col->bit, &keep);
+            uint8_t* out = column_row(dst, col, base + k);
+            if (payload != NULL) {
+                memcpy(out, payload, col->elem_size);
+            } else if (keep && src_col != NULL) {
+                memcpy(out, column_row(src, src_col, migration->row), col->elem_size);
+            } else {
+                memset(out, 0, col->elem_size);
+            }
+            if (col->tracked) {
+                bool copied = payload == NULL && keep && src_col != NULL && src_col->tracked;
+                set_row_tick(dst, col, base + k, copied ? src_col->ticks[migration->row] : world->change_tick);
+            }
+        }
+    }
+
+    for (size_t k = 0; k < count; k++) {
+        freecs_entity_t entity = migrations[order[k].value].entity;
+        dst->entities[base + k] = entity;
+        world->locations[entity.id] = (freecs_entity_location_t){
+            .generation = entity.generation,
+            .archetype_index = dst_idx,
+            .row = (uint32_t)(base + k),
+        };
+    }
+    dst->entities_len += count;
+}
+
+static void apply_component_commands(freecs_world_t* world, const freecs_command_buffer_t* buffer, size_t begin, size_t end) {
+    const freecs_command_t* commands = buffer->commands;
+    size_t count = end - begin;
+    size_t per_command = 4 * sizeof(freecs_sort_item_t) + sizeof(freecs_migration_t) + 2 * sizeof(size_t) + 1;
+    uint8_t* scratch_base = world_scratch(world, count * per_command);
+    freecs_sort_item_t* refs = (freecs_sort_item_t*)scratch_base;
+    freecs_sort_item_t* order = refs + count;
+    freecs_sort_item_t* scratch = order + count;
+    size_t* rows = (size_t*)(scratch + 2 * count);
+    size_t* sources = rows + count;
+    freecs_migration_t* migrations = (freecs_migration_t*)(sources + count);
+    uint8_t* marks = (uint8_t*)(migrations + count);
+
+    for (size_t i = 0; i < count; i++) {
+        refs[i] = (freecs_sort_item_t){(uint64_t)commands[begin + i].entity.id << 32 | (begin + i), (uint32_t)(begin + i)};
+    }
+    radix_sort_items(refs, scratch, count);
+
+    size_t migrations_len = 0;
+    uint32_t cached_src = UINT32_MAX;
+    freecs_mask_t cached_mask = FREECS_MASK_EMPTY;
+    uint32_t cached_dst = FREECS_MIGRATE_DESPAWN;
+
+    for (size_t i = 0; i < count;) {
+        uint32_t entity_id = (uint32_t)(refs[i].key >> 32);
+        size_t group_end = i + 1;
+        while (group_end < count && (uint32_t)(refs[group_end].key >> 32) == entity_id) group_end++;
+
+        size_t live_end = i;
+        freecs_entity_t entity = FREECS_ENTITY_NIL;
+        for (size_t r = i; r < group_end; r++) {
+            freecs_entity_t candidate = commands[refs[r].value].entity;
+            if (freecs_is_alive(world, candidate)) {
+                entity = candidate;
+                refs[live_end++] = refs[r];
+            }
+        }
+
+        if (live_end > i) {
+            freecs_entity_location_t* loc = &world->locations[entity.id];
+            freecs_mask_t src_mask = world->archetypes[loc->archetype_index].mask;
+            freecs_mask_t mask = src_mask;
+            for (size_t r = i; r < live_end; r++) {
+                const freecs_command_t* cmd = &commands[refs[r].value];
+                if (cmd->command_type == FREECS_CMD_ADD_COMPONENTS) {
+                    mask = freecs_mask_or(mask, cmd->mask);
+                } else {
+                    mask = freecs_mask_andnot(mask, cmd->mask);
+                }
+            }
+
+            freecs_migration_t migration = {
+                .entity = entity,
+                .src = loc->archetype_index,
+                .dst = FREECS_MIGRATE_DESPAWN,
+                .row = loc->row,
+                .first = (uint32_t)i,
+                .count = (uint32_t)(live_end - i)
+            };
+
+            if (freecs_mask_equal(mask, src_mask)) {
+                write_in_place(world, buffer, refs, &migration);
+            } else {
+                if (!freecs_mask_is_empty(mask)) {
+                    if (migration.src != cached_src || !freecs_mask_equal(mask, cached_mask)) {
+                        cached_src = migration.src;
+                        cached_mask = mask;
+                        cached_dst = (uint32_t)resolve_archetype(world, mask);
+                    }
+                    migration.dst = cached_dst;
+                }
+                order[migrations_len] = (freecs_sort_item_t){(uint64_t)migration.src << 32 | migration.dst, (uint32_t)migrations_len};
+                migrations[migrations_len++] = migration;
+            }
+        }
+
+        i = group_end;
+    }
+
+    radix_sort_items(order, scratch, migrations_len);
+
+    for (size_t i = 0; i < migrations_len;) {
+        uint32_t src = migrations[order[i].value].src;
+        size_t src_end = i;
+        while (src_end < migrations_len && migrations[order[src_end].value].src == src) {
+            size_t dst_end = src_end;
+            while (dst_end < migrations_len && order[dst_end].key == order[src_end].key) dst_end++;
+            if (migrations[order[src_end].value].dst != FREECS_MIGRATE_DESPAWN) {
+                migrate_rows(world, buffer, refs, migrations, &order[src_end], dst_end - src_end);
+            }
+            src_end = dst_end;
+        }
+
+        for (size_t m = i; m < src_end; m++) {
+            rows[m - i] = migrations[order[m].value].row;
+        }
+        archetype_remove_rows(world, &world->archetypes[src], rows, src_end - i, sources, marks);
+
+        for (size_t m = i; m < src_end; m++) {
+            const freecs_migration_t* migration = &migrations[order[m].value];
+            if (migration->dst == FREECS_MIGRATE_DESPAWN) {
+                record_transition(world, world->archetypes[src].mask, FREECS_MASK_EMPTY, &migration->entity, 1);
+                release_entity(world, migration->entity);
+            } else {
+                record_transition(world, world->archetypes[src].mask, world->archetypes[migration->dst].mask, &migration->entity, 1);
+            }
+        }
+
+        i = src_end;
+    }
+}
+
+void freecs_apply_commands(freecs_command_buffer_t* buffer) {
+    size_t i = 0;
+    while (i < buffer->commands_len) {
+        freecs_command_t* cmd = &buffer->commands[i];
+
+        switch (cmd->command_type) {
+            case FREECS_CMD_SPAWN: {
+                freecs_type_info_entry_t entries[FREECS_MAX_COMPONENTS];
+                const freecs_command_component_t* components = command_components(buffer, cmd);
+                for (size_t j = 0; j < cmd->components_len; j++) {
+                    entries[j].bit = components[j].bit;
+                    entries[j].size = components[j].size;
+                    entries[j].data = components[j].size > 0 ? &buffer->arena[components[j].data_offset] : NULL;
+                    entries[j].type_index = freecs_bit_index(components[j].bit);
+                }
+                freecs_spawn(buffer->world, cmd->mask, entries, cmd->components_len);
+                i++;
+                break;
+            }
+            case FREECS_CMD_DESPAWN:
+                freecs_despawn(buffer->world, cmd->entity);
+                i++;
+                break;
+            case FREECS_CMD_ADD_COMPONENTS:
+            case FREECS_CMD_REMOVE_COMPONENTS: {
+                size_t run_end = i + 1;
+                while (run_end < buffer->commands_len &&
+                       (buffer->commands[run_end].command_type == FREECS_CMD_ADD_COMPONENTS ||
+                        buffer->commands[run_end].command_type == FREECS_CMD_REMOVE_COMPONENTS)) {
+                    run_end++;
+                }
+                apply_component_commands(buffer->world, buffer, i, run_end);
+                i = run_end;
+                break;
+            }
+        }
+    }
+
+    freecs_clear_command_buffer(buffer);
+}
+
+freecs_thread_commands_t freecs_create_thread_commands(freecs_world_t* world, size_t thread_count) {
+    if (thread_count == 0) thread_count = 1;
+    freecs_thread_commands_t commands = {
+        .threads = (freecs_thread_command_buffer_t*)aligned_alloc_block(_Alignof(freecs_thread_command_buffer_t), thread_count * sizeof(freecs_thread_command_buffer_t)),
+        .threads_len = thread_count,
+        .merged = freecs_create_command_buffer(world),
+        .world = world
+    };
+    for (size_t i = 0; i < thread_count; i++) {
+        commands.threads[i] = (freecs_thread_command_buffer_t){
+            .commands = freecs_create_command_buffer(world)
+        };
+    }
+    return commands;
+}
+
+void freecs_destroy_thread_commands(freecs_thread_commands_t* commands) {
+    for (size_t i = 0; i < commands->threads_len; i++) {
+        freecs_destroy_command_buffer(&commands->threads[i].commands);
+        free(commands->threads[i].segments);
+    }
+    aligned_free_block((uint8_t*)commands->threads);
+    freecs_destroy_command_buffer(&commands->merged);
+    memset(commands, 0, sizeof(*commands));
+}
+
+freecs_command_buffer_t* freecs_thread_commands_begin(freecs_thread_commands_t* commands, size_t thread_index, uint64_t sort_key) {
+    freecs_thread_command_buffer_t* thread = &commands->threads[thread_index];
+    if (thread->segments_len > 0 && thread->segments[thread->segments_len - 1].key == sort_key) {
+        return &thread->commands;
+    }
+    ensure_capacity_segments(&thread->segments, &thread->segments_cap, thread->segments_len + 1);
+    thread->segments[thread->segments_len++] = (freecs_command_segment_t){sort_key, thread->commands.commands_len};
+    return &thread->commands;
+}
+
+static void copy_command(freecs_command_buffer_t* target, const freecs_command_buffer_t* source, const freecs_command_t* cmd) {
+    ensure_capacity_commands(&target->commands, &target->commands_cap, target->commands_len + 1);
+    freecs_command_t* copy = &target->commands[target->commands_len++];
+    *copy = *cmd;
+    if (cmd->components_len == 0) return;
+
+    const freecs_command_component_t* components = command_components(source, cmd);
+    size_t block = cmd->components_len * sizeof(freecs_command_component_t);
+    for (size_t j = 0; j < cmd->components_len; j++) {
+        block += components[j].size;
+    }
+
+    size_t header = align_up(target->arena_len, _Alignof(freecs_command_component_t));
+    ensure_capacity_u8(&target->arena, &target->arena_cap, header + block);
+    memcpy(&target->arena[header], &source->arena[cmd->components_offset], block);
+
+    freecs_command_component_t* copied = (freecs_command_component_t*)(target->arena + header);
+    for (size_t j = 0; j < cmd->components_len; j++) {
+        copied[j].data_offset = copied[j].data_offset - cmd->components_offset + header;
+    }
+    copy->components_offset = header;
+    target->arena_len = header + block;
+}
+
+void freecs_merge_thread_commands(freecs_thread_commands_t* commands, freecs_command_buffer_t* target) {
+    size_t segments_len = 0;
+    for (size_t t = 0; t < commands->threads_len; t++) {
+        segments_len += commands->threads[t].segments_len;
+    }
+
+    uint8_t* scratch_base = world_scratch(commands->world, segments_len * (2 * sizeof(freecs_sort_item_t) + 2 * sizeof(uint32_t)));
+    freecs_sort_item_t* order = (freecs_sort_item_t*)scratch_base;
+    freecs_sort_item_t* scratch = order + segments_len;
+    uint32_t* segment_threads = (uint32_t*)(scratch + segments_len);
+    uint32_t* segment_indices = segment_threads + segments_len;
+
+    size_t index = 0;
+    for (size_t t = 0; t < commands->threads_len; t++) {
+        for (size_t k = 0; k < commands->threads[t].segments_len; k++) {
+            segment_threads[index] = (uint32_t)t;
+            segment_indices[index] = (uint32_t)k;
+            order[index] = (freecs_sort_item_t){commands->threads[t].segments[k].key, (uint32_t)index};
+            index++;
+        }
+    }
+    radix_sort_items(order, scratch, segments_len);
+
+    for (size_t i = 0; i < segments_len; i++) {
+        freecs_thread_command_buffer_t* thread = &commands->threads[segment_threads[order[i].value]];
+        size_t k = segment_indices[order[i].value];
+        size_t end = k + 1 < thread->segments_len ? thread->segments[k + 1].begin : thread->commands.commands_len;
+        for (size_t c = thread->segments[k].begin; c < end; c++) {
+            copy_command(target, &thread->commands, &thread->commands.commands[c]);
+        }
+    }
+
+    for (size_t t = 0; t < commands->threads_len; t++) {
+        freecs_clear_command_buffer(&commands->threads[t].commands);
+        commands->threads[t].segments_len = 0;
+    }
+}
+
+void freecs_apply_thread_commands(freecs_thread_commands_t* commands) {
+    freecs_merge_thread_commands(commands, &commands->merged);
+    freecs_apply_commands(&commands->merged);
+}
+
+freecs_scheduler_t freecs_create_scheduler(freecs_world_t* world, freecs_thread_pool_t* pool) {
+    return (freecs_scheduler_t){
+        .world = world,
+        .pool = pool,
+        .dirty = true
+    };
+}
+
+void freecs_destroy_scheduler(freecs_scheduler_t* scheduler) {
+    for (size_t i = 0; i < scheduler->systems_len; i++) {
+        freecs_destroy_command_buffer(&scheduler->systems[i].commands);
+    }
+    free(scheduler->systems);
+    free(scheduler->order);
+    free(scheduler->level_starts);
+    memset(scheduler, 0, sizeof(*scheduler));
+}
+
+size_t freecs_add_system(freecs_scheduler_t* scheduler, const char* name, freecs_system_fn run, freecs_mask_t read, freecs_mask_t write, void* user) {
+    size_t index = scheduler->systems_len;
+    ensure_capacity_systems(&scheduler->systems, &scheduler->systems_cap, index + 1);
+    scheduler->systems[index] = (freecs_system_t){
+        .name = name,
+        .run = run,
+        .read = read,
+        .write = write,
+        .user = user,
+        .barrier = scheduler->barriers,
+        .level = 0,
+        .commands = freecs_create_command_buffer(scheduler->world)
+    };
+    scheduler->systems_len++;
+    scheduler->dirty = true;
+    return index;
+}
+
+void freecs_add_sync_point(freecs_scheduler_t* scheduler) {
+    scheduler->barriers++;
+    scheduler->dirty = true;
+}
+
+static bool systems_conflict(const freecs_system_t* a, const freecs_system_t* b) {
+    return a->barrier != b->barrier ||
+           freecs_mask_intersects(a->write, freecs_mask_or(b->read, b->write)) ||
+           freecs_mask_intersects(b->write, a->read);
+}
+
+static void build_schedule(freecs_scheduler_t* scheduler) {
+    scheduler->levels_len = 0;
+    for (size_t j = 0; j < scheduler->systems_len; j++) {
+        freecs_system_t* system = &scheduler->systems[j];
+        system->level = 0;
+        for (size_t i = 0; i < j; i++) {
+            freecs_system_t* earlier = &scheduler->systems[i];
+            if (earlier->level + 1 > system->level && systems_conflict(earlier, system)) {
+                system->level = earlier->level + 1;
+            }
+        }
+        if (system->level + 1 > scheduler->levels_len) {
+            scheduler->levels_len = system->level + 1;
+        }
+    }
+
+    scheduler->order = realloc(scheduler->order, (scheduler->systems_len + 1) * sizeof(size_t));
+    scheduler->level_starts = realloc(scheduler->level_starts, (scheduler->levels_len + 1) * sizeof(size_t));
+    memset(scheduler->level_starts, 0, (scheduler->levels_len + 1) * sizeof(size_t));
+
+    for (size_t i = 0; i < scheduler->systems_len; i++) {
+        scheduler->level_starts[scheduler->systems[i].level + 1]++;
+    }
+    for (size_t level = 0; level < scheduler->levels_len; level++) {
+        scheduler->level_starts[level + 1] += scheduler->level_starts[level];
+    }
+
+    size_t* cursor = malloc((scheduler->levels_len + 1) * sizeof(size_t));
+    memcpy(cursor, scheduler->level_starts, (scheduler->levels_len + 1) * sizeof(size_t));
+    for (size_t i = 0; i < scheduler->systems_len; i++) {
+        scheduler->order[cursor[scheduler->systems[i].level]++] = i;
+    }
+    free(cursor);
+
+    scheduler->dirty = false;
+}
+
+typedef struct {
+    freecs_scheduler_t* scheduler;
+    const size_t* systems;
+} freecs_level_ctx_t;
+
+static void run_system_task(size_t task, size_t thread_index, void* ctx) {
+    (void)thread_index;
+    freecs_level_ctx_t* level = ctx;
+    freecs_system_t* system = &level->scheduler->systems[level->systems[task]];
+    system->run(level->scheduler->world, &system->commands, system->user);
+}
+
+void freecs_run_schedule(freecs_scheduler_t* scheduler) {
+    if (scheduler->dirty) build_schedule(scheduler);
+
+    for (size_t level = 0; level < scheduler->levels_len; level++) {
+        size_t start = scheduler->level_starts[level];
+        size_t count = scheduler->level_starts[level + 1] - start;
+        freecs_level_ctx_t ctx = {scheduler, &scheduler->order[start]};
+
+        if (scheduler->pool != NULL && count > 1 && pool_acquire(scheduler->pool)) {
+            pool_run(scheduler->pool, count, run_system_task, &ctx);
+            pool_release(scheduler->pool);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                run_system_task(i, current_thread_index, &ctx);
+            }
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            freecs_apply_commands(&scheduler->systems[scheduler->order[start + i]].commands);
+        }
+    }
+}
+
+#define FREECS_SPATIAL_NONE UINT32_MAX
+
+freecs_spatial_index_t freecs_create_spatial_index(freecs_world_t* world, freecs_mask_t position, float cell_size, size_t bucket_count) {
+    size_t buckets_len = 64;
+    while (buckets_len < bucket_count) buckets_len *= 2;
+
+    freecs_observe_components(world, position);
+    const freecs_component_events_t* events = &world->component_events[freecs_bit_index(position)];
+
+    return (freecs_spatial_index_t){
+        .world = world,
+        .position = position,
+        .cell_size = cell_size,
+        .inv_cell = 1.0f / cell_size,
+        .buckets = calloc(buckets_len, sizeof(freecs_spatial_bucket_t)),
+        .buckets_len = buckets_len,
+        .removed_cursor = events->removed_base + events->removed_len
+    };
+}
+
+void freecs_destroy_spatial_index(freecs_spatial_index_t* index) {
+    for (size_t i = 0; i < index->buckets_len; i++) {
+        free(index->buckets[i].entries);
+    }
+    free(index->buckets);
+    free(index->slots);
+    free(index->hits);
+    memset(index, 0, sizeof(*index));
+}
+
+static inline int32_t spatial_coord(float value, float inv_cell) {
+    float scaled = value * inv_cell;
+    if (!(scaled > (float)INT32_MIN)) return INT32_MIN;
+    if (scaled >= (float)INT32_MAX) return INT32_MAX;
+    int32_t coord = (int32_t)scaled;
+    if ((float)coord > scaled) coord--;
+    return coord;
+}
+
+static inline uint32_t spatial_bucket(const freecs_spatial_index_t* index, int32_t cell_x, int32_t cell_y) {
+    uint32_t hash = (uint32_t)cell_x * 73856093u ^ (uint32_t)cell_y * 19349663u;
+    return hash & (uint32_t)(index->buckets_len - 1);
+}
+
+static void spatial_insert(freecs_spatial_index_t* index, freecs_spatial_entry_t entry) {
+    uint32_t bucket_idx = spatial_bucket(index, entry.cell_x, entry.cell_y);
+    freecs_spatial_bucket_t* bucket = &index->buckets[bucket_idx];
+    ensure_capacity_spatial_entries(&bucket->entries, &bucket->cap, bucket->len + 1);
+    index->slots[entry.entity.id] = (freecs_spatial_slot_t){bucket_idx, (uint32_t)bucket->len};
+    bucket->entries[bucket->len++] = entry;
+}
+
+static void spatial_remove(freecs_spatial_index_t* index, uint32_t id) {
+    freecs_spatial_slot_t slot = index->slots[id];
+    freecs_spatial_bucket_t* bucket = &index->buckets[slot.bucket];
+    freecs_spatial_entry_t* last = &bucket->entries[--bucket->len];
+    if (slot.slot < bucket->len) {
+        bucket->entries[slot.slot] = *last;
+        index->slots[last->entity.id].slot = slot.slot;
+    }
+    index->slots[id].bucket = FREECS_SPATIAL_NONE;
+}
+
+void freecs_spatial_update(freecs_spatial_index_t* index, uint32_t since_tick) {
+    freecs_world_t* world = index->world;
+    size_t elem_size = world->type_sizes[freecs_bit_index(index->position)];
+
+    size_t slots_needed = world->locations_len;
+    if (slots_needed > index->slots_len) {
+        ensure_capacity_spatial_slots(&index->slots, &index->slots_cap, slots_needed);
+        for (size_t i = index->slots_len; i < slots_needed; i++) {
+            index->slots[i].bucket = FREECS_SPATIAL_NONE;
+        }
+        index->slots_len = slots_needed;
+    }
+
+    const freecs_component_events_t* events = &world->component_events[freecs_bit_index(index->position)];
+    if (index->removed_cursor < events->removed_base) {
+        for (size_t b = 0; b < index->buckets_len; b++) {
+            freecs_spatial_bucket_t* bucket = &index->buckets[b];
+            size_t i = 0;
+            while (i < bucket->len) {
+                if (!freecs_has(world, bucket->entries[i].entity, index->position)) {
+                    spatial_remove(index, bucket->entries[i].entity.id);
+                    index->count--;
+                } else {
+                    i++;
+                }
+            }
+        }
+    } else {
+        for (size_t i = (size_t)(index->removed_cursor - events->removed_base); i < events->removed_len; i++) {
+            freecs_entity_t entity = events->removed[i];
+            freecs_spatial_slot_t slot = index->slots[entity.id];
+            if (slot.bucket == FREECS_SPATIAL_NONE) continue;
+            if (index->buckets[slot.bucket].entries[slot.slot].entity.generation != entity.generation) continue;
+            if (freecs_has(world, entity, index->position)) continue;
+            spatial_remove(index, entity.id);
+            index->count--;
+        }
     }
+    index->removed_cursor = events->removed_base + events->removed_len;
+
+    freecs_table_iterator_t iter = freecs_mask_intersects(world->tracked, index->position)
+        ? freecs_query_changed(world, index->position, since_tick)
+        : freecs_table_iterator(world, index->position, FREECS_MASK_EMPTY);
+
+    freecs_table_iterator_result_t view;
+    while (freecs_table_iterator_next(&iter, &view)) {
+        const uint8_t* rows = freecs_iter_column(&view, index->position);
+        const freecs_entity_t* entities = &view.archetype->entities[view.row_start];
+        for (size_t i = 0; i < view.row_count; i++) {
+            const float* position = (const float*)(rows + i * elem_size);
+            freecs_spatial_entry_t entry = {
+                entities[i], position[0], position[1],
+                spatial_coord(position[0], index->inv_cell), spatial_coord(position[1], index->inv_cell)
+            };
+
+            freecs_spatial_slot_t slot = index->slots[entry.entity.id];
+            if (slot.bucket == FREECS_SPATIAL_NONE) {
+                spatial_insert(index, entry);
+                index->count++;
+            } else {
+                freecs_spatial_entry_t* current = &index->buckets[slot.bucket].entries[slot.slot];
+                if (current->cell_x == entry.cell_x && current->cell_y == entry.cell_y) {
+                    *current = entry;
+                } else {
+                    spatial_remove(index, entry.entity.id);
+                    spatial_insert(index, entry);
+                }
+            }
+        }
+    }
+}
+
+size_t freecs_spatial_query_radius(freecs_spatial_index_t* index, float x, float y, float radius, freecs_entity_t* out, size_t max_out) {
+    float radius_sq = radius * radius;
+    int32_t min_x = spatial_coord(x - radius, index->inv_cell);
+    int32_t max_x = spatial_coord(x + radius, index->inv_cell);
+    int32_t min_y = spatial_coord(y - radius, index->inv_cell);
+    int32_t max_y = spatial_coord(y + radius, index->inv_cell);
+    size_t found = 0;
+
+    uint64_t span_x = (uint64_t)((int64_t)max_x - min_x + 1);
+    uint64_t span_y = (uint64_t)((int64_t)max_y - min_y + 1);
+    if (span_x >= index->buckets_len || span_y >= index->buckets_len || span_x * span_y >= index->buckets_len) {
+        for (size_t b = 0; b < index->buckets_len; b++) {
+            const freecs_spatial_bucket_t* bucket = &index->buckets[b];
+            for (size_t i = 0; i < bucket->len; i++) {
+                const freecs_spatial_entry_t* entry = &bucket->entries[i];
+                float dx = entry->x - x;
+                float dy = entry->y - y;
+                if (dx * dx + dy * dy <= radius_sq) {
+                    if (found < max_out) out[found] = entry->entity;
+                    found++;
+                }
+            }
+        }
+        return found;
+    }
+
+    for (int64_t cell_y = min_y; cell_y <= max_y; cell_y++) {
+        for (int64_t cell_x = min_x; cell_x <= max_x; cell_x++) {
+            const freecs_spatial_bucket_t* bucket = &index->buckets[spatial_bucket(index, (int32_t)cell_x, (int32_t)cell_y)];
+            for (size_t i = 0; i < bucket->len; i++) {
+                const freecs_spatial_entry_t* entry = &bucket->entries[i];
+                if (entry->cell_x != cell_x || entry->cell_y != cell_y) continue;
+                float dx = entry->x - x;
+                float dy = entry->y - y;
+                if (dx * dx + dy * dy <= radius_sq) {
+                    if (found < max_out) out[found] = entry->entity;
+                    found++;
+                }
+            }
+        }
+    }
+    return found;
+}
+
+static void spatial_heap_push(freecs_spatial_hit_t* heap, size_t* len, size_t k, freecs_spatial_hit_t hit) {
+    if (*len == k) {
+        if (hit.dist_sq >= heap[0].dist_sq) return;
+        size_t i = 0;
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= k) break;
+            if (child + 1 < k && heap[child + 1].dist_sq > heap[child].dist_sq) child++;
+            if (heap[child].dist_sq <= hit.dist_sq) break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        heap[i] = hit;
+        return;
+    }
+
+    size_t i = (*len)++;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (heap[parent].dist_sq >= hit.dist_sq) break;
+        heap[i] = heap[parent];
+        i = parent;
+    }
+    heap[i] = hit;
+}
+
+static void spatial_scan_cell(const freecs_spatial_index_t* index, int64_t cell_x, int64_t cell_y, float x, float y, float max_sq,
+                              freecs_spatial_hit_t* heap, size_t* len, size_t k, size_t* visited) {
+    if (cell_x < INT32_MIN || cell_x > INT32_MAX || cell_y < INT32_MIN || cell_y > INT32_MAX) return;
+    const freecs_spatial_bucket_t* bucket = &index->buckets[spatial_bucket(index, (int32_t)cell_x, (int32_t)cell_y)];
+    for (size_t i = 0; i < bucket->len; i++) {
+        const freecs_spatial_entry_t* entry = &bucket->entries[i];
+        if (entry->cell_x != cell_x || entry->cell_y != cell_y) continue;
+        (*visited)++;
+        float dx = entry->x - x;
+        float dy = entry->y - y;
+        float dist_sq = dx * dx + dy * dy;
+        if (dist_sq <= max_sq) {
+            spatial_heap_push(heap, len, k, (freecs_spatial_hit_t){dist_sq, entry->entity});
+        }
+    }
+}
+
+size_t freecs_spatial_query_nearest(freecs_spatial_index_t* index, float x, float y, size_t k, float max_radius, freecs_entity_t* out) {
+    if (k == 0 || index->count == 0) return 0;
+
+    ensure_capacity_spatial_hits(&index->hits, &index->hits_cap, k);
+    freecs_spatial_hit_t* heap = index->hits;
+    size_t len = 0;
+    size_t visited = 0;
+    float max_sq = max_radius > 0.0f ? max_radius * max_radius : 3.4e38f;
+
+    int32_t center_x = spatial_coord(x, index->inv_cell);
+    int32_t center_y = spatial_coord(y, index->inv_cell);
+    float offset_x = x * index->inv_cell - (float)center_x;
+    float offset_y = y * index->inv_cell - (float)center_y;
+    float edge = offset_x < 1.0f - offset_x ? offset_x : 1.0f - offset_x;
+    if (offset_y < edge) edge = offset_y;
+    if (1.0f - offset_y < edge) edge = 1.0f - offset_y;
+
+    for (int64_t ring = 0;; ring++) {
+        if (ring > 0) {
+            float bound = ((float)(ring - 1) + edge) * index->cell_size;
+            float bound_sq = bound * bound;
+            if (bound_sq > max_sq) break;
+            if (len == k && bound_sq >= heap[0].dist_sq) break;
+        }
+        if (visited == index->count) break;
+
+        uint64_t side = (uint64_t)(2 * ring + 1);
+        if (side * side > index->buckets_len) {
+            len = 0;
+            for (size_t b = 0; b < index->buckets_len; b++) {
+                const freecs_spatial_bucket_t* bucket = &index->buckets[b];
+                for (size_t i = 0; i < bucket->len; i++) {
+                    const freecs_spatial_entry_t* entry = &bucket->entries[i];
+                    float dx = entry->x - x;
+                    float dy = entry->y - y;
+                    float dist_sq = dx * dx + dy * dy;
+                    if (dist_sq <= max_sq) {
+                        spatial_heap_push(heap, &len, k, (freecs_spatial_hit_t){dist_sq, entry->entity});
+                    }
+                }
+            }
+            break;
+        }
+
+        if (ring == 0) {
+            spatial_scan_cell(index, center_x, center_y, x, y, max_sq, heap, &len, k, &visited);
+            continue;
+        }
+        for (int64_t d = -ring; d <= ring; d++) {
+            spatial_scan_cell(index, center_x + d, center_y - ring, x, y, max_sq, heap, &len, k, &visited);
+            spatial_scan_cell(index, center_x + d, center_y + ring, x, y, max_sq, heap, &len, k, &visited);
+        }
+        for (int64_t d = -ring + 1; d <= ring - 1; d++) {
+            spatial_scan_cell(index, center_x - ring, center_y + d, x, y, max_sq, heap, &len, k, &visited);
+            spatial_scan_cell(index, center_x + ring, center_y + d, x, y, max_sq, heap, &len, k, &visited);
+        }
+    }
+
+    size_t found = len;
+    while (len > 0) {
+        freecs_spatial_hit_t top = heap[0];
+        freecs_spatial_hit_t last = heap[--len];
+        size_t i = 0;
+        for (;;) {
+            size_t child = 2 * i + 1;
+            if (child >= len) break;
+            if (child + 1 < len && heap[child + 1].dist_sq > heap[child].dist_sq) child++;
+            if (heap[child].dist_sq <= last.dist_sq) break;
+            heap[i] = heap[child];
+            i = child;
+        }
+        if (len > 0) heap[i] = last;
+        out[len] = top.entity;
+    }
+    return found;
+}
+
+freecs_tags_t freecs_create_tags(void) {
+    freecs_tags_t tags = {0};
+    return tags;
+}
+
+void freecs_destroy_tags(freecs_tags_t* tags) {
+    for (int i = 0; i < FREECS_MAX_TAGS; i++) {
+        freecs_tag_storage_t* storage = &tags->storage[i];
+        for (size_t p = 0; p < storage->pages_len; p++) {
+            free(storage->pages[p]);
+        }
+        free(storage->pages);
+        free(storage->dense);
+    }
+    free(tags->entity_masks);
     memset(tags, 0, sizeof(*tags));
 }
 
@@ -915,48 +2765,78 @@ int freecs_register_tag(freecs_tags_t* tags, const char* name) {
     return tag_id;
 }
 
+static uint32_t* tag_slot(const freecs_tag_storage_t* storage, uint32_t id) {
+    size_t page = id / FREECS_TAG_PAGE_SIZE;
+    if (page >= storage->pages_len || storage->pages[page] == NULL) return NULL;
+    return &storage->pages[page][id % FREECS_TAG_PAGE_SIZE];
+}
+
+static uint32_t* tag_slot_create(freecs_tag_storage_t* storage, uint32_t id) {
+    size_t page = id / FREECS_TAG_PAGE_SIZE;
+    if (page >= storage->pages_len) {
+        size_t new_len = storage->pages_len == 0 ? 4 : storage->pages_len * 2;
+        while (new_len <= page) new_len *= 2;
+        storage->pages = realloc(storage->pages, new_len * sizeof(uint32_t*));
+        memset(&storage->pages[storage->pages_len], 0, (new_len - storage->pages_len) * sizeof(uint32_t*));
+        storage->pages_len = new_len;
+    }
+    if (storage->pages[page] == NULL) {
+        storage->pages[page] = calloc(FREECS_TAG_PAGE_SIZE, sizeof(uint32_t));
+    }
+    return &storage->pages[page][id % FREECS_TAG_PAGE_SIZE];
+}
+
+static uint64_t* tag_mask_create(freecs_tags_t* tags, uint32_t id) {
+    if (id >= tags->entity_masks_len) {
+        size_t new_len = tags->entity_masks_len == 0 ? 64 : tags->entity_masks_len * 2;
+        while (new_len <= id) new_len *= 2;
+        tags->entity_masks = realloc(tags->entity_masks, new_len * sizeof(uint64_t));
+        memset(&tags->entity_masks[tags->entity_masks_len], 0, (new_len - tags->entity_masks_len) * sizeof(uint64_t));
+        tags->entity_masks_len = new_len;
+    }
+    return &tags->entity_masks[id];
+}
+
 void freecs_add_tag(freecs_tags_t* tags, int tag_id, freecs_entity_t entity) {
     if (tag_id < 0 || tag_id >= FREECS_MAX_TAGS) return;
 
+    *tag_mask_create(tags, entity.id) |= FREECS_TAG_BIT(tag_id);
     freecs_tag_storage_t* storage = &tags->storage[tag_id];
-
-    for (size_t i = 0; i < storage->entries_len; i++) {
-        if (storage->entries[i].entity.id == entity.id) {
-            storage->entries[i].entity = entity;
-            return;
-        }
+    uint32_t* slot = tag_slot_create(storage, entity.id);
+    if (*slot != 0) {
+        storage->dense[*slot - 1] = entity;
+        return;
     }
 
-    ensure_capacity_tag_entries(&storage->entries, &storage->entries_cap, storage->entries_len + 1);
-    storage->entries[storage->entries_len++] = (freecs_tag_entry_t){entity, 0};
+    ensure_capacity_entities(&storage->dense, &storage->dense_cap, storage->dense_len + 1);
+    storage->dense[storage->dense_len++] = entity;
+    *slot = (uint32_t)storage->dense_len;
 }
 
 void freecs_remove_tag(freecs_tags_t* tags, int tag_id, freecs_entity_t entity) {
     if (tag_id < 0 || tag_id >= FREECS_MAX_TAGS) return;
 
     freecs_tag_storage_t* storage = &tags->storage[tag_id];
-
-    for (size_t i = 0; i < storage->entries_len; i++) {
-        if (storage->entries[i].entity.id == entity.id) {
-            storage->entries[i] = storage->entries[storage->entries_len - 1];
-            storage->entries_len--;
-            return;
-        }
+    uint32_t* slot = tag_slot(storage, entity.id);
+    if (slot == NULL || *slot == 0) return;
+
+    size_t index = *slot - 1;
+    freecs_entity_t last = storage->dense[--storage->dense_len];
+    if (index < storage->dense_len) {
+        storage->dense[index] = last;
+        *tag_slot(storage, last.id) = (uint32_t)(index + 1);
     }
+    *slot = 0;
+    tags->entity_masks[entity.id] &= ~FREECS_TAG_BIT(tag_id);
 }
 
 bool freecs_has_tag(freecs_tags_t* tags, int tag_id, freecs_entity_t entity) {
     if (tag_id < 0 || tag_id >= FREECS_MAX_TAGS) return false;
 
     freecs_tag_storage_t* storage = &tags->storage[tag_id];
-
-    for (size_t i = 0; i < storage->entries_len; i++) {
-        if (storage->entries[i].entity.id == entity.id &&
-            storage->entries[i].entity.generation == entity.generation) {
-            return true;
-        }
-    }
-    return false;
+    uint32_t* slot = tag_slot(storage, entity.id);
+    if (slot == NULL || *slot == 0) return false;
+    return storage->dense[*slot - 1].generation == entity.generation;
 }
 
 freecs_entity_t* freecs_query_tag(freecs_tags_t* tags, int tag_id, size_t* out_count) {
@@ -966,29 +2846,154 @@ freecs_entity_t* freecs_query_tag(freecs_tags_t* tags, int tag_id, size_t* out_c
     }
 
     freecs_tag_storage_t* storage = &tags->storage[tag_id];
-    if (storage->entries_len == 0) {
+    if (storage->dense_len == 0) {
         *out_count = 0;
         return NULL;
     }
 
-    freecs_entity_t* entities = malloc(storage->entries_len * sizeof(freecs_entity_t));
-    for (size_t i = 0; i < storage->entries_len; i++) {
-        entities[i] = storage->entries[i].entity;
-    }
+    freecs_entity_t* entities = malloc(storage->dense_len * sizeof(freecs_entity_t));
+    memcpy(entities, storage->dense, storage->dense_len * sizeof(freecs_entity_t));
 
-    *out_count = storage->entries_len;
+    *out_count = storage->dense_len;
     return entities;
 }
 
+const freecs_entity_t* freecs_tag_entities(freecs_tags_t* tags, int tag_id, size_t* out_count) {
+    if (tag_id < 0 || tag_id >= FREECS_MAX_TAGS) {
+        *out_count = 0;
+        return NULL;
+    }
+    *out_count = tags->storage[tag_id].dense_len;
+    return tags->storage[tag_id].dense;
+}
+
 size_t freecs_tag_count(freecs_tags_t* tags, int tag_id) {
     if (tag_id < 0 || tag_id >= FREECS_MAX_TAGS) return 0;
-    return tags->storage[tag_id].entries_len;
+    return tags->storage[tag_id].dense_len;
 }
 
 void freecs_clear_entity_tags(freecs_tags_t* tags, freecs_entity_t entity) {
-    for (int i = 0; i < FREECS_MAX_TAGS; i++) {
-        freecs_remove_tag(tags, i, entity);
+    if (entity.id >= tags->entity_masks_len) return;
+
+    uint64_t held = tags->entity_masks[entity.id];
+    for (int tag_id = 0; held != 0; tag_id++, held >>= 1) {
+        if (held & 1) freecs_remove_tag(tags, tag_id, entity);
+    }
+}
+
+uint64_t freecs_entity_tags(freecs_tags_t* tags, freecs_entity_t entity) {
+    if (entity.id >= tags->entity_masks_len) return 0;
+
+    uint64_t held = tags->entity_masks[entity.id];
+    uint64_t result = 0;
+    for (int tag_id = 0; held != 0; tag_id++, held >>= 1) {
+        if ((held & 1) && freecs_has_tag(tags, tag_id, entity)) result |= FREECS_TAG_BIT(tag_id);
+    }
+    return result;
+}
+
+void freecs_attach_tags(freecs_world_t* world, freecs_tags_t* tags) {
+    world->tags = tags;
+}
+
+static bool tags_match(freecs_tags_t* tags, uint64_t include, uint64_t exclude, freecs_entity_t entity) {
+    uint64_t held = entity.id < tags->entity_masks_len ? tags->entity_masks[entity.id] : 0;
+    if ((held & include) != include) return false;
+
+    exclude &= held;
+    for (int tag_id = 0; (include | exclude) != 0; tag_id++) {
+        uint64_t bit = FREECS_TAG_BIT(tag_id);
+        if (include & bit) {
+            if (!freecs_has_tag(tags, tag_id, entity)) return false;
+            include &= ~bit;
+        } else if (exclude & bit) {
+            if (freecs_has_tag(tags, tag_id, entity)) return false;
+            exclude &= ~bit;
+        }
+    }
+    return true;
+}
+
+freecs_tag_query_t freecs_tag_query(freecs_world_t* world, freecs_tags_t* tags, freecs_mask_t mask, freecs_mask_t exclude, uint64_t tag_include, uint64_t tag_exclude) {
+    freecs_tag_query_t query = {
+        .world = world,
+        .tags = tags,
+        .mask = mask,
+        .exclude = exclude,
+        .tag_include = tag_include,
+        .tag_exclude = tag_exclude,
+        .driver = -1,
+        .index = 0,
+        .tables = freecs_table_iterator(world, mask, exclude)
+    };
+
+    size_t smallest = freecs_query_count(world, mask, exclude);
+    for (int tag_id = 0; tag_id < FREECS_MAX_TAGS; tag_id++) {
+        if ((tag_include & FREECS_TAG_BIT(tag_id)) && tags->storage[tag_id].dense_len < smallest) {
+            smallest = tags->storage[tag_id].dense_len;
+            query.driver = tag_id;
+        }
+    }
+    return query;
+}
+
+size_t freecs_tag_query_fill(freecs_tag_query_t* query, freecs_tag_query_result_t* out, size_t max_out) {
+    freecs_world_t* world = query->world;
+    freecs_tags_t* tags = query->tags;
+    uint64_t tag_exclude = query->tag_exclude;
+    size_t found = 0;
+
+    if (query->driver >= 0) {
+        const freecs_tag_storage_t* storage = &tags->storage[query->driver];
+        const freecs_entity_t* dense = storage->dense;
+        size_t len = storage->dense_len;
+        uint64_t include = query->tag_include & ~FREECS_TAG_BIT(query->driver);
+        size_t index = query->index;
+        while (index < len && found < max_out) {
+            if (index + FREECS_TAG_QUERY_PREFETCH < len) {
+                uint32_t ahead = dense[index + FREECS_TAG_QUERY_PREFETCH].id;
+                if (ahead < world->locations_len) __builtin_prefetch(&world->locations[ahead]);
+            }
+            freecs_entity_t entity = dense[index++];
+            if (entity.id >= world->locations_len) continue;
+
+            freecs_entity_location_t* loc = &world->locations[entity.id];
+            if (!location_holds(loc, entity)) continue;
+
+            freecs_archetype_t* arch = &world->archetypes[loc->archetype_index];
+            if (!freecs_mask_contains(arch->mask, query->mask) || freecs_mask_intersects(arch->mask, query->exclude)) continue;
+            if ((include | tag_exclude) && !tags_match(tags, include, tag_exclude, entity)) continue;
+
+            out[found++] = (freecs_tag_query_result_t){entity, arch, loc->row};
+        }
+        query->index = index;
+        return found;
     }
+
+    uint64_t include = query->tag_include;
+    while (found < max_out) {
+        if (query->index >= query->view.row_count) {
+            if (!freecs_table_iterator_next(&query->tables, &query->view)) break;
+            query->index = 0;
+            continue;
+        }
+        freecs_archetype_t* arch = query->view.archetype;
+        size_t end = query->view.row_count;
+        size_t index = query->index;
+        while (index < end && found < max_out) {
+            size_t row = query->view.row_start + index++;
+            freecs_entity_t entity = arch->entities[row];
+            if ((include | tag_exclude) && !tags_match(tags, include, tag_exclude, entity)) continue;
+
+            out[found++] = (freecs_tag_query_result_t){entity, arch, row};
+        }
+        query->index = index;
+    }
+    return found;
+}
+
+bool freecs_tag_query_next(freecs_tag_query_t* query, freecs_tag_query_result_t* result) {
+    return freecs_tag_query_fill(query, result, 1) == 1;
 }
 
 freecs_event_queue_t freecs_create_event_queue(size_t elem_size) {
@@ -996,30 +3001,155 @@ freecs_event_queue_t freecs_create_event_queue(size_t elem_size) {
         .data = NULL,
         .data_len = 0,
         .data_cap = 0,
-        .elem_size = elem_size
+        .previous = NULL,
+        .previous_len = 0,
+        .previous_cap = 0,
+        .elem_size = elem_size,
+        .data_start = 0,
+        .previous_start = 0
     };
 }
 
 void freecs_destroy_event_queue(freecs_event_queue_t* queue) {
     free(queue->data);
+    free(queue->previous);
+    for (size_t i = 0; i < FREECS_EVENT_CHUNKS; i++) {
+        free(atomic_load_explicit(&queue->chunks[i], memory_order_relaxed));
+    }
     memset(queue, 0, sizeof(*queue));
 }
 
+static void flush_pending_events(freecs_event_queue_t* queue) {
+    size_t pending = atomic_load_explicit(&queue->pending, memory_order_acquire);
+    if (pending == 0) return;
+
+    ensure_capacity_u8(&queue->data, &queue->data_cap, queue->data_len + pending * queue->elem_size);
+    size_t copied = 0;
+    for (size_t chunk = 0; copied < pending; chunk++) {
+        size_t count = (size_t)FREECS_EVENT_CHUNK_EVENTS << chunk;
+        if (count > pending - copied) count = pending - copied;
+        uint8_t* storage = atomic_load_explicit(&queue->chunks[chunk], memory_order_relaxed);
+        memcpy(&queue->data[queue->data_len], storage, count * queue->elem_size);
+        queue->data_len += count * queue->elem_size;
+        copied += count;
+    }
+    atomic_store_explicit(&queue->pending, 0, memory_order_relaxed);
+}
+
+static uint8_t* event_chunk(freecs_event_queue_t* queue, size_t chunk) {
+    uint8_t* storage = atomic_load_explicit(&queue->chunks[chunk], memory_order_acquire);
+    if (storage != NULL) return storage;
+
+    uint8_t* fresh = malloc(((size_t)FREECS_EVENT_CHUNK_EVENTS << chunk) * queue->elem_size);
+    if (atomic_compare_exchange_strong_explicit(&queue->chunks[chunk], &storage, fresh, memory_order_acq_rel, memory_order_acquire)) {
+        return fresh;
+    }
+    free(fresh);
+    return storage;
+}
+
+static size_t event_chunk_of(size_t index, size_t* offset) {
+    size_t block = index / FREECS_EVENT_CHUNK_EVENTS + 1;
+    size_t chunk = 63 - (size_t)__builtin_clzll((unsigned long long)block);
+    *offset = index - FREECS_EVENT_CHUNK_EVENTS * (((size_t)1 << chunk) - 1);
+    return chunk;
+}
+
+void freecs_par_send_event(freecs_event_queue_t* queue, const void* event) {
+    size_t index = atomic_fetch_add_explicit(&queue->pending, 1, memory_order_relaxed);
+    size_t offset;
+    size_t chunk = event_chunk_of(index, &offset);
+    memcpy(&event_chunk(queue, chunk)[offset * queue->elem_size], event, queue->elem_size);
+}
+
+void freecs_par_send_events(freecs_event_queue_t* queue, const void* events, size_t count) {
+    if (count == 0) return;
+
+    size_t index = atomic_fetch_add_explicit(&queue->pending, count, memory_order_relaxed);
+    const uint8_t* source = events;
+    while (count > 0) {
+        size_t offset;
+        size_t chunk = event_chunk_of(index, &offset);
+        size_t room = ((size_t)FREECS_EVENT_CHUNK_EVENTS << chunk) - offset;
+        size_t take = count < room ? count : room;
+        memcpy(&event_chunk(queue, chunk)[offset * queue->elem_size], source, take * queue->elem_size);
+        source += take * queue->elem_size;
+        index += take;
+        count -= take;
+    }
+}
+
 void freecs_send_event(freecs_event_queue_t* queue, const void* event) {
+    flush_pending_events(queue);
     ensure_capacity_u8(&queue->data, &queue->data_cap, queue->data_len + queue->elem_size);
     memcpy(&queue->data[queue->data_len], event, queue->elem_size);
     queue->data_len += queue->elem_size;
 }
 
 void* freecs_read_events(freecs_event_queue_t* queue, size_t* out_count) {
+    flush_pending_events(queue);
     *out_count = queue->data_len / queue->elem_size;
     return queue->data;
 }
 
 void freecs_clear_events(freecs_event_queue_t* queue) {
+    atomic_store_explicit(&queue->pending, 0, memory_order_relaxed);
+    queue->data_start += queue->data_len / queue->elem_size;
+    queue->previous_start = queue->data_start;
     queue->data_len = 0;
+    queue->previous_len = 0;
 }
 
 size_t freecs_event_count(freecs_event_queue_t* queue) {
+    flush_pending_events(queue);
     return queue->data_len / queue->elem_size;
 }
+
+void freecs_update_events(freecs_event_queue_t* queue) {
+    flush_pending_events(queue);
+    uint8_t* recycled = queue->previous;
+    size_t recycled_cap = queue->previous_cap;
+
+    queue->previous = queue->data;
+    queue->previous_len = queue->data_len;
+    queue->previous_cap = queue->data_cap;
+    queue->previous_start = queue->data_start;
+
+    queue->data = recycled;
+    queue->data_len = 0;
+    queue->data_cap = recycled_cap;
+    queue->data_start = queue->previous_start + queue->previous_len / queue->elem_size;
+}
+
+freecs_event_reader_t freecs_event_reader(freecs_event_queue_t* queue) {
+    return (freecs_event_reader_t){queue->previous_start};
+}
+
+void* freecs_read_new_events(freecs_event_queue_t* queue, freecs_event_reader_t* reader, size_t* out_count) {
+    flush_pending_events(queue);
+    if (reader->next < queue->previous_start) reader->next = queue->previous_start;
+
+    if (reader->next < queue->data_start) {
+        size_t skip = (size_t)(reader->next - queue->previous_start);
+        *out_count = queue->previous_len / queue->elem_size - skip;
+        reader->next = queue->data_start;
+        return &queue->previous[skip * queue->elem_size];
+    }
+
+    size_t skip = (size_t)(reader->next - queue->data_start);
+    size_t total = queue->data_len / queue->elem_size;
+    if (skip >= total) {
+        *out_count = 0;
+        return NULL;
+    }
+    *out_count = total - skip;
+    reader->next = queue->data_start + total;
+    return &queue->data[skip * queue->elem_size];
+}
+
+size_t freecs_unread_event_count(freecs_event_queue_t* queue, const freecs_event_reader_t* reader) {
+    flush_pending_events(queue);
+    uint64_t end = queue->data_start + queue->data_len / queue->elem_size;
+    uint64_t next = reader->next < queue->previous_start ? queue->previous_start : reader->next;
+    return next < end ? (size_t)(end - next) : 0;
+}
@@ -4,9 +4,47 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdatomic.h>
 
+#ifndef FREECS_MAX_COMPONENTS
 #define FREECS_MAX_COMPONENTS 64
+#endif
+
 #define FREECS_MIN_ENTITY_CAPACITY 64
+#define FREECS_INLINE_EDGES 4
+
+#ifndef FREECS_CHUNK_SIZE
+#define FREECS_CHUNK_SIZE 16384
+#endif
+
+#ifndef FREECS_CHUNK_ALIGN
+#define FREECS_CHUNK_ALIGN 64
+#endif
+
+#ifndef FREECS_PAR_BATCH_ROWS
+#define FREECS_PAR_BATCH_ROWS 4096
+#endif
+
+#ifndef FREECS_CHANGE_BLOCK_ROWS
+#define FREECS_CHANGE_BLOCK_ROWS 1024
+#endif
+
+#if FREECS_MAX_COMPONENTS == 64
+#define FREECS_MASK_WORDS 1
+typedef uint64_t freecs_mask_t;
+#define FREECS_MASK_EMPTY ((freecs_mask_t){0})
+#elif FREECS_MAX_COMPONENTS == 128 || FREECS_MAX_COMPONENTS == 256 || FREECS_MAX_COMPONENTS == 512
+#define FREECS_WIDE_MASK
+#define FREECS_MASK_WORDS (FREECS_MAX_COMPONENTS / 64)
+typedef struct {
+    uint64_t words[FREECS_MASK_WORDS];
+} freecs_mask_t;
+typedef uint64_t freecs_mask_lanes_t __attribute__((vector_size(sizeof(freecs_mask_t)), aligned(8), may_alias));
+#define FREECS_MASK_LANES(mask) (*(freecs_mask_lanes_t*)(mask).words)
+#define FREECS_MASK_EMPTY ((freecs_mask_t){{0}})
+#else
+#error "FREECS_MAX_COMPONENTS must be 64, 128, 256 or 512"
+#endif
 
 typedef struct {
     uint32_t id;
@@ -15,29 +53,46 @@ typedef struct {
 
 #define FREECS_ENTITY_NIL ((freecs_entity_t){0, 0})
 
+#define FREECS_GENERATION_DEAD 0x80000000u
+
 typedef struct {
     uint32_t archetype_index;
     uint32_t row;
     uint32_t generation;
-    bool alive;
 } freecs_entity_location_t;
 
 typedef struct {
+#ifdef FREECS_CHUNKED_STORAGE
+    size_t chunk_offset;
+#else
     uint8_t* data;
-    size_t data_len;
     size_t data_cap;
+#endif
     size_t elem_size;
-    uint64_t bit;
+    size_t elem_align;
+    freecs_mask_t bit;
     size_t type_index;
+    bool tracked;
+    uint32_t* ticks;
+    uint32_t* block_ticks;
+    size_t ticks_cap;
 } freecs_component_column_t;
 
 typedef struct {
-    int32_t add_edges[FREECS_MAX_COMPONENTS];
-    int32_t remove_edges[FREECS_MAX_COMPONENTS];
+    uint32_t key;
+    int32_t target;
+} freecs_edge_t;
+
+typedef struct {
+    freecs_edge_t inline_edges[FREECS_INLINE_EDGES];
+    size_t inline_len;
+    freecs_edge_t* overflow;
+    size_t overflow_len;
+    size_t overflow_cap;
 } freecs_table_edges_t;
 
 typedef struct {
-    uint64_t mask;
+    freecs_mask_t mask;
     freecs_entity_t* entities;
     size_t entities_len;
     size_t entities_cap;
@@ -46,6 +101,17 @@ typedef struct {
     size_t columns_cap;
     int32_t column_bits[FREECS_MAX_COMPONENTS];
     freecs_table_edges_t edges;
+    bool tracked;
+    size_t change_shift;
+#ifdef FREECS_CHUNKED_STORAGE
+    uint8_t** chunks;
+    size_t chunks_len;
+    size_t chunks_cap;
+    size_t chunk_rows;
+    size_t chunk_shift;
+    size_t chunk_bytes;
+    size_t chunk_align;
+#endif
 } freecs_archetype_t;
 
 typedef struct {
@@ -55,10 +121,30 @@ typedef struct {
 } freecs_index_array_t;
 
 typedef struct {
-    uint64_t key;
+    freecs_mask_t mask;
+    size_t archetype_index;
+    bool occupied;
+} freecs_archetype_slot_t;
+
+typedef struct {
+    freecs_mask_t include;
+    freecs_mask_t exclude;
     freecs_index_array_t value;
+    bool occupied;
 } freecs_cache_entry_t;
 
+typedef struct {
+    freecs_entity_t* added;
+    size_t added_len;
+    size_t added_cap;
+    freecs_entity_t* removed;
+    size_t removed_len;
+    size_t removed_cap;
+    uint64_t removed_base;
+} freecs_component_events_t;
+
+typedef struct freecs_tags_t freecs_tags_t;
+
 typedef struct {
     freecs_entity_location_t* locations;
     size_t locations_len;
@@ -68,73 +154,141 @@ typedef struct {
     size_t archetypes_len;
     size_t archetypes_cap;
 
-    freecs_cache_entry_t* archetype_index;
+    freecs_archetype_slot_t* archetype_index;
     size_t archetype_index_len;
     size_t archetype_index_cap;
 
     size_t type_sizes[FREECS_MAX_COMPONENTS];
+    size_t type_aligns[FREECS_MAX_COMPONENTS];
 
     freecs_entity_t* free_entities;
     size_t free_entities_len;
     size_t free_entities_cap;
 
     uint32_t next_entity_id;
-    uint64_t next_bit;
+    size_t next_component;
 
     freecs_cache_entry_t* query_cache;
     size_t query_cache_len;
     size_t query_cache_cap;
+    atomic_flag query_lock;
 
     freecs_entity_t* despawn_queue;
     size_t despawn_queue_len;
     size_t despawn_queue_cap;
+
+    uint8_t* scratch;
+    size_t scratch_cap;
+
+    freecs_mask_t tracked;
+    uint32_t change_tick;
+
+    freecs_mask_t observed;
+    freecs_component_events_t* component_events;
+
+    freecs_tags_t* tags;
 } freecs_world_t;
 
 typedef struct {
     freecs_world_t* world;
-    uint64_t mask;
-    uint64_t exclude;
+    freecs_mask_t mask;
+    freecs_mask_t exclude;
     size_t* indices;
     size_t indices_len;
     size_t current;
+    size_t row;
+    freecs_mask_t changed;
+    uint32_t since_tick;
 } freecs_table_iterator_t;
 
 typedef struct {
     freecs_archetype_t* archetype;
     size_t index;
+    size_t row_start;
+    size_t row_count;
 } freecs_table_iterator_result_t;
 
 typedef struct {
-    uint64_t bit;
+    freecs_mask_t bit;
     size_t size;
     const void* data;
     size_t type_index;
 } freecs_type_info_entry_t;
 
+#ifndef FREECS_EVENT_CHUNK_EVENTS
+#define FREECS_EVENT_CHUNK_EVENTS 256
+#endif
+
+#define FREECS_EVENT_CHUNKS 32
+
 typedef struct {
     uint8_t* data;
     size_t data_len;
     size_t data_cap;
+    uint8_t* previous;
+    size_t previous_len;
+    size_t previous_cap;
     size_t elem_size;
+    uint64_t data_start;
+    uint64_t previous_start;
+    uint8_t* _Atomic chunks[FREECS_EVENT_CHUNKS];
+    atomic_size_t pending;
 } freecs_event_queue_t;
 
 typedef struct {
-    freecs_entity_t entity;
-    uint64_t mask;
-} freecs_tag_entry_t;
+    uint64_t next;
+} freecs_event_reader_t;
+
+#ifndef FREECS_TAG_PAGE_SIZE
+#define FREECS_TAG_PAGE_SIZE 4096
+#endif
+
+#ifndef FREECS_TAG_QUERY_PREFETCH
+#define FREECS_TAG_QUERY_PREFETCH 8
+#endif
 
 typedef struct {
-    freecs_tag_entry_t* entries;
-    size_t entries_len;
-    size_t entries_cap;
+    freecs_entity_t* dense;
+    size_t dense_len;
+    size_t dense_cap;
+    uint32_t** pages;
+    size_t pages_len;
 } freecs_tag_storage_t;
 
 #define FREECS_MAX_TAGS 64
 
-typedef struct {
+struct freecs_tags_t {
     freecs_tag_storage_t storage[FREECS_MAX_TAGS];
     int next_tag;
-} freecs_tags_t;
+    uint64_t* entity_masks;
+    size_t entity_masks_len;
+};
+
+#define FREECS_TAG_BIT(tag_id) ((uint64_t)1 << (tag_id))
+
+typedef struct {
+    freecs_world_t* world;
+    freecs_tags_t* tags;
+    freecs_mask_t mask;
+    freecs_mask_t exclude;
+    uint64_t tag_include;
+    uint64_t tag_exclude;
+    int driver;
+    size_t index;
+    freecs_table_iterator_t tables;
+    freecs_table_iterator_result_t view;
+} freecs_tag_query_t;
+
+typedef struct {
+    freecs_entity_t entity;
+    freecs_archetype_t* archetype;
+    size_t row;
+} freecs_tag_query_result_t;
+
+typedef struct freecs_thread_pool_t freecs_thread_pool_t;
+
+typedef void (*freecs_par_table_fn)(const freecs_table_iterator_result_t* view, size_t thread_index, void* user);
+typedef void (*freecs_par_row_fn)(freecs_archetype_t* arch, size_t row, size_t thread_index, void* user);
 
 typedef enum {
     FREECS_CMD_SPAWN,
@@ -143,63 +297,184 @@ typedef enum {
     FREECS_CMD_REMOVE_COMPONENTS
 } freecs_command_type_t;
 
+typedef struct {
+    freecs_mask_t bit;
+    size_t size;
+    size_t data_offset;
+} freecs_command_component_t;
+
 typedef struct {
     freecs_command_type_t command_type;
     freecs_entity_t entity;
-    uint64_t mask;
-    uint8_t* component_data;
-    size_t component_data_len;
-    size_t component_data_cap;
-    size_t* component_sizes;
-    size_t component_sizes_len;
-    uint64_t* component_bits;
-    size_t component_bits_len;
+    freecs_mask_t mask;
+    size_t components_offset;
+    size_t components_len;
 } freecs_command_t;
 
 typedef struct {
     freecs_command_t* commands;
     size_t commands_len;
     size_t commands_cap;
+    uint8_t* arena;
+    size_t arena_len;
+    size_t arena_cap;
     freecs_world_t* world;
 } freecs_command_buffer_t;
 
+typedef struct {
+    uint64_t key;
+    size_t begin;
+} freecs_command_segment_t;
+
+typedef struct {
+    _Alignas(64) freecs_command_buffer_t commands;
+    freecs_command_segment_t* segments;
+    size_t segments_len;
+    size_t segments_cap;
+} freecs_thread_command_buffer_t;
+
+typedef struct {
+    freecs_thread_command_buffer_t* threads;
+    size_t threads_len;
+    freecs_command_buffer_t merged;
+    freecs_world_t* world;
+} freecs_thread_commands_t;
+
+typedef void (*freecs_system_fn)(freecs_world_t* world, freecs_command_buffer_t* commands, void* user);
+
+typedef struct {
+    const char* name;
+    freecs_system_fn run;
+    freecs_mask_t read;
+    freecs_mask_t write;
+    void* user;
+    size_t barrier;
+    size_t level;
+    freecs_command_buffer_t commands;
+} freecs_system_t;
+
+typedef struct {
+    freecs_world_t* world;
+    freecs_thread_pool_t* pool;
+    freecs_system_t* systems;
+    size_t systems_len;
+    size_t systems_cap;
+    size_t* order;
+    size_t* level_starts;
+    size_t levels_len;
+    size_t barriers;
+    bool dirty;
+} freecs_scheduler_t;
+
+typedef struct {
+    freecs_entity_t entity;
+    float x;
+    float y;
+    int32_t cell_x;
+    int32_t cell_y;
+} freecs_spatial_entry_t;
+
+typedef struct {
+    freecs_spatial_entry_t* entries;
+    size_t len;
+    size_t cap;
+} freecs_spatial_bucket_t;
+
+typedef struct {
+    uint32_t bucket;
+    uint32_t slot;
+} freecs_spatial_slot_t;
+
+typedef struct {
+    float dist_sq;
+    freecs_entity_t entity;
+} freecs_spatial_hit_t;
+
+typedef struct {
+    freecs_world_t* world;
+    freecs_mask_t position;
+    float cell_size;
+    float inv_cell;
+    freecs_spatial_bucket_t* buckets;
+    size_t buckets_len;
+    freecs_spatial_slot_t* slots;
+    size_t slots_len;
+    size_t slots_cap;
+    size_t count;
+    uint64_t removed_cursor;
+    freecs_spatial_hit_t* hits;
+    size_t hits_cap;
+} freecs_spatial_index_t;
+
 freecs_world_t freecs_create_world(void);
 void freecs_destroy_world(freecs_world_t* world);
 
-uint64_t freecs_register_component(freecs_world_t* world, size_t size);
+freecs_mask_t freecs_register_component(freecs_world_t* world, size_t size);
+freecs_mask_t freecs_register_component_aligned(freecs_world_t* world, size_t size, size_t align);
 
-freecs_entity_t freecs_spawn(freecs_world_t* world, uint64_t mask, const freecs_type_info_entry_t* entries, size_t entry_count);
-freecs_entity_t* freecs_spawn_batch(freecs_world_t* world, uint64_t mask, size_t count, size_t* out_count);
-freecs_entity_t* freecs_spawn_with_init(freecs_world_t* world, uint64_t mask, size_t count, void (*init_callback)(freecs_archetype_t*, size_t), size_t* out_count);
+freecs_entity_t freecs_spawn(freecs_world_t* world, freecs_mask_t mask, const freecs_type_info_entry_t* entries, size_t entry_count);
+freecs_entity_t* freecs_spawn_batch(freecs_world_t* world, freecs_mask_t mask, size_t count, size_t* out_count);
+freecs_entity_t* freecs_spawn_batch_columns(freecs_world_t* world, freecs_mask_t mask, size_t count, const void* const* column_sources, size_t* out_count);
+freecs_entity_t* freecs_spawn_with_init(freecs_world_t* world, freecs_mask_t mask, size_t count, void (*init_callback)(freecs_archetype_t*, size_t), size_t* out_count);
 bool freecs_despawn(freecs_world_t* world, freecs_entity_t entity);
 size_t freecs_despawn_batch(freecs_world_t* world, const freecs_entity_t* entities, size_t count);
 
 bool freecs_is_alive(freecs_world_t* world, freecs_entity_t entity);
 
-void* freecs_get(freecs_world_t* world, freecs_entity_t entity, uint64_t bit);
-void* freecs_get_unchecked(freecs_world_t* world, freecs_entity_t entity, uint64_t bit);
-bool freecs_set(freecs_world_t* world, freecs_entity_t entity, uint64_t bit, const void* value, size_t size);
-bool freecs_has(freecs_world_t* world, freecs_entity_t entity, uint64_t bit);
-bool freecs_has_components(freecs_world_t* world, freecs_entity_t entity, uint64_t mask);
-uint64_t freecs_component_mask(freecs_world_t* world, freecs_entity_t entity, bool* ok);
-
-bool freecs_add_component(freecs_world_t* world, freecs_entity_t entity, uint64_t bit, const void* value, size_t size);
-bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, uint64_t bit);
-
-size_t* freecs_get_matching_archetypes(freecs_world_t* world, uint64_t mask, uint64_t exclude, size_t* out_count);
-size_t freecs_query_count(freecs_world_t* world, uint64_t mask, uint64_t exclude);
-freecs_entity_t* freecs_query_entities(freecs_world_t* world, uint64_t mask, uint64_t exclude, size_t* out_count);
-freecs_entity_t freecs_query_first(freecs_world_t* world, uint64_t mask, uint64_t exclude, bool* found);
+void* freecs_get(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit);
+void* freecs_get_unchecked(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit);
+void* freecs_get_mut(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit);
+bool freecs_set(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit, const void* value, size_t size);
+bool freecs_has(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit);
+bool freecs_has_components(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t mask);
+freecs_mask_t freecs_component_mask(freecs_world_t* world, freecs_entity_t entity, bool* ok);
+
+bool freecs_add_component(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit, const void* value, size_t size);
+bool freecs_remove_component(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit);
+
+size_t* freecs_get_matching_archetypes(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, size_t* out_count);
+size_t freecs_query_count(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude);
+freecs_entity_t* freecs_query_entities(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, size_t* out_count);
+freecs_entity_t freecs_query_first(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, bool* found);
 size_t freecs_entity_count(freecs_world_t* world);
 
-void* freecs_column(freecs_archetype_t* arch, uint64_t bit, size_t* out_count);
-void* freecs_column_unchecked(freecs_archetype_t* arch, uint64_t bit);
+/* With FREECS_CHUNKED_STORAGE a column is split into one slice per chunk of
+   arch->chunk_rows rows, so there is no flat array to index up to entities_len.
+   freecs_column, freecs_column_unchecked and FREECS_COLUMN are compile errors
+   in that mode. Use the table iterator, whose results never cross a chunk, with
+   FREECS_ITER_COLUMN, or freecs_column_row for a single row. */
+#ifndef FREECS_CHUNKED_STORAGE
+void* freecs_column(freecs_archetype_t* arch, freecs_mask_t bit, size_t* out_count);
+void* freecs_column_unchecked(freecs_archetype_t* arch, freecs_mask_t bit);
+#endif
+void* freecs_column_row(freecs_archetype_t* arch, freecs_mask_t bit, size_t row);
 
-freecs_table_iterator_t freecs_table_iterator(freecs_world_t* world, uint64_t mask, uint64_t exclude);
+freecs_table_iterator_t freecs_table_iterator(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude);
 bool freecs_table_iterator_next(freecs_table_iterator_t* iter, freecs_table_iterator_result_t* result);
-
-void freecs_for_each(freecs_world_t* world, uint64_t mask, uint64_t exclude, void (*callback)(freecs_archetype_t*, size_t));
-void freecs_for_each_table(freecs_world_t* world, uint64_t mask, uint64_t exclude, void (*callback)(freecs_archetype_t*));
+void* freecs_iter_column(const freecs_table_iterator_result_t* result, freecs_mask_t bit);
+void* freecs_iter_column_mut(freecs_world_t* world, const freecs_table_iterator_result_t* result, freecs_mask_t bit);
+
+void freecs_track_changes(freecs_world_t* world, freecs_mask_t mask);
+uint32_t freecs_change_tick(freecs_world_t* world);
+uint32_t freecs_advance_tick(freecs_world_t* world);
+void freecs_mark_changed(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit);
+bool freecs_changed_since(freecs_world_t* world, freecs_entity_t entity, freecs_mask_t bit, uint32_t since_tick);
+freecs_table_iterator_t freecs_query_changed(freecs_world_t* world, freecs_mask_t mask, uint32_t since_tick);
+
+void freecs_observe_components(freecs_world_t* world, freecs_mask_t mask);
+const freecs_entity_t* freecs_added(freecs_world_t* world, freecs_mask_t bit, size_t* out_count);
+const freecs_entity_t* freecs_removed(freecs_world_t* world, freecs_mask_t bit, size_t* out_count);
+freecs_entity_t* freecs_query_added(freecs_world_t* world, freecs_mask_t bit, freecs_mask_t mask, freecs_mask_t exclude, size_t* out_count);
+void freecs_clear_component_events(freecs_world_t* world);
+
+void freecs_for_each(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, void (*callback)(freecs_archetype_t*, size_t));
+void freecs_for_each_table(freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, void (*callback)(freecs_archetype_t*));
+
+freecs_thread_pool_t* freecs_create_thread_pool(size_t thread_count);
+void freecs_destroy_thread_pool(freecs_thread_pool_t* pool);
+size_t freecs_thread_pool_size(const freecs_thread_pool_t* pool);
+void freecs_par_for_each_table(freecs_thread_pool_t* pool, freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, freecs_par_table_fn callback, void* user);
+void freecs_par_for_each(freecs_thread_pool_t* pool, freecs_world_t* world, freecs_mask_t mask, freecs_mask_t exclude, freecs_par_row_fn callback, void* user);
 
 void freecs_queue_despawn(freecs_world_t* world, freecs_entity_t entity);
 void freecs_apply_despawns(freecs_world_t* world);
@@ -207,12 +482,31 @@ void freecs_apply_despawns(freecs_world_t* world);
 freecs_command_buffer_t freecs_create_command_buffer(freecs_world_t* world);
 void freecs_destroy_command_buffer(freecs_command_buffer_t* buffer);
 void freecs_clear_command_buffer(freecs_command_buffer_t* buffer);
-void freecs_queue_spawn(freecs_command_buffer_t* buffer, uint64_t mask, const freecs_type_info_entry_t* entries, size_t entry_count);
+void freecs_queue_spawn(freecs_command_buffer_t* buffer, freecs_mask_t mask, const freecs_type_info_entry_t* entries, size_t entry_count);
 void freecs_cmd_queue_despawn(freecs_command_buffer_t* buffer, freecs_entity_t entity);
-void freecs_queue_add_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, uint64_t mask);
-void freecs_queue_remove_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, uint64_t mask);
+void freecs_queue_add_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, freecs_mask_t mask);
+void freecs_queue_add_components_with_data(freecs_command_buffer_t* buffer, freecs_entity_t entity, freecs_mask_t mask, const freecs_type_info_entry_t* entries, size_t entry_count);
+void freecs_queue_remove_components(freecs_command_buffer_t* buffer, freecs_entity_t entity, freecs_mask_t mask);
 void freecs_apply_commands(freecs_command_buffer_t* buffer);
 
+freecs_thread_commands_t freecs_create_thread_commands(freecs_world_t* world, size_t thread_count);
+void freecs_destroy_thread_commands(freecs_thread_commands_t* commands);
+freecs_command_buffer_t* freecs_thread_commands_begin(freecs_thread_commands_t* commands, size_t thread_index, uint64_t sort_key);
+void freecs_merge_thread_commands(freecs_thread_commands_t* commands, freecs_command_buffer_t* target);
+void freecs_apply_thread_commands(freecs_thread_commands_t* commands);
+
+freecs_scheduler_t freecs_create_scheduler(freecs_world_t* world, freecs_thread_pool_t* pool);
+void freecs_destroy_scheduler(freecs_scheduler_t* scheduler);
+size_t freecs_add_system(freecs_scheduler_t* scheduler, const char* name, freecs_system_fn run, freecs_mask_t read, freecs_mask_t write, void* user);
+void freecs_add_sync_point(freecs_scheduler_t* scheduler);
+void freecs_run_schedule(freecs_scheduler_t* scheduler);
+
+freecs_spatial_index_t freecs_create_spatial_index(freecs_world_t* world, freecs_mask_t position, float cell_size, size_t bucket_count);
+void freecs_destroy_spatial_index(freecs_spatial_index_t* index);
+void freecs_spatial_update(freecs_spatial_index_t* index, uint32_t since_tick);
+size_t freecs_spatial_query_radius(freecs_spatial_index_t* index, float x, float y, float radius, freecs_entity_t* out, size_t max_out);
+size_t freecs_spatial_query_nearest(freecs_spatial_index_t* index, float x, float y, size_t k, float max_radius, freecs_entity_t* out);
+
 freecs_tags_t freecs_create_tags(void);
 void freecs_destroy_tags(freecs_tags_t* tags);
 int freecs_register_tag(freecs_tags_t* tags, const char* name);
@@ -221,28 +515,131 @@ void freecs_remove_tag(freecs_tags_t* tags, int tag_id, freecs_entity_t entity);
 bool freecs_has_tag(freecs_tags_t* tags, int tag_id, freecs_entity_t entity);
 freecs_entity_t* freecs_query_tag(freecs_tags_t* tags, int tag_id, size_t* out_count);
 size_t freecs_tag_count(freecs_tags_t* tags, int tag_id);
+const freecs_entity_t* freecs_tag_entities(freecs_tags_t* tags, int tag_id, size_t* out_count);
 void freecs_clear_entity_tags(freecs_tags_t* tags, freecs_entity_t entity);
+uint64_t freecs_entity_tags(freecs_tags_t* tags, freecs_entity_t entity);
+void freecs_attach_tags(freecs_world_t* world, freecs_tags_t* tags);
+freecs_tag_query_t freecs_tag_query(freecs_world_t* world, freecs_tags_t* tags, freecs_mask_t mask, freecs_mask_t exclude, uint64_t tag_include, uint64_t tag_exclude);
+bool freecs_tag_query_next(freecs_tag_query_t* query, freecs_tag_query_result_t* result);
+size_t freecs_tag_query_fill(freecs_tag_query_t* query, freecs_tag_query_result_t* out, size_t max_out);
 
 freecs_event_queue_t freecs_create_event_queue(size_t elem_size);
 void freecs_destroy_event_queue(freecs_event_queue_t* queue);
 void freecs_send_event(freecs_event_queue_t* queue, const void* event);
+void freecs_par_send_event(freecs_event_queue_t* queue, const void* event);
+void freecs_par_send_events(freecs_event_queue_t* queue, const void* events, size_t count);
 void* freecs_read_events(freecs_event_queue_t* queue, size_t* out_count);
 void freecs_clear_events(freecs_event_queue_t* queue);
 size_t freecs_event_count(freecs_event_queue_t* queue);
+void freecs_update_events(freecs_event_queue_t* queue);
+freecs_event_reader_t freecs_event_reader(freecs_event_queue_t* queue);
+void* freecs_read_new_events(freecs_event_queue_t* queue, freecs_event_reader_t* reader, size_t* out_count);
+size_t freecs_unread_event_count(freecs_event_queue_t* queue, const freecs_event_reader_t* reader);
+
+static inline freecs_mask_t freecs_mask_bit(size_t index) {
+#ifdef FREECS_WIDE_MASK
+    freecs_mask_t mask = {0};
+    mask.words[index / 64] = (uint64_t)1 << (index % 64);
+    return mask;
+#else
+    return (uint64_t)1 << index;
+#endif
+}
+
+static inline freecs_mask_t freecs_mask_or(freecs_mask_t a, freecs_mask_t b) {
+#ifdef FREECS_WIDE_MASK
+    FREECS_MASK_LANES(a) |= FREECS_MASK_LANES(b);
+    return a;
+#else
+    return a | b;
+#endif
+}
 
-static inline size_t freecs_bit_index(uint64_t bit) {
+static inline freecs_mask_t freecs_mask_and(freecs_mask_t a, freecs_mask_t b) {
+#ifdef FREECS_WIDE_MASK
+    FREECS_MASK_LANES(a) &= FREECS_MASK_LANES(b);
+    return a;
+#else
+    return a & b;
+#endif
+}
+
+static inline freecs_mask_t freecs_mask_andnot(freecs_mask_t a, freecs_mask_t b) {
+#ifdef FREECS_WIDE_MASK
+    FREECS_MASK_LANES(a) &= ~FREECS_MASK_LANES(b);
+    return a;
+#else
+    return a & ~b;
+#endif
+}
+
+static inline bool freecs_mask_is_empty(freecs_mask_t mask) {
+#ifdef FREECS_WIDE_MASK
+    uint64_t any = 0;
+    for (size_t i = 0; i < FREECS_MASK_WORDS; i++) {
+        any |= mask.words[i];
+    }
+    return any == 0;
+#else
+    return mask == 0;
+#endif
+}
+
+static inline bool freecs_mask_test(freecs_mask_t mask, size_t index) {
+#ifdef FREECS_WIDE_MASK
+    return (mask.words[index / 64] >> (index % 64)) & 1;
+#else
+    return (mask >> index) & 1;
+#endif
+}
+
+static inline bool freecs_mask_contains(freecs_mask_t mask, freecs_mask_t subset) {
+    return freecs_mask_is_empty(freecs_mask_andnot(subset, mask));
+}
+
+static inline bool freecs_mask_intersects(freecs_mask_t a, freecs_mask_t b) {
+    return !freecs_mask_is_empty(freecs_mask_and(a, b));
+}
+
+static inline bool freecs_mask_equal(freecs_mask_t a, freecs_mask_t b) {
+#ifdef FREECS_WIDE_MASK
+    uint64_t diff = 0;
+    for (size_t i = 0; i < FREECS_MASK_WORDS; i++) {
+        diff |= a.words[i] ^ b.words[i];
+    }
+    return diff == 0;
+#else
+    return a == b;
+#endif
+}
+
+static inline size_t freecs_bit_index(freecs_mask_t bit) {
+#ifdef FREECS_WIDE_MASK
+    size_t word = 0;
+    while (bit.words[word] == 0) {
+        word++;
+    }
+    uint64_t value = bit.words[word];
+#else
+    size_t word = 0;
+    uint64_t value = bit;
+#endif
     size_t count = 0;
-    while ((bit & 1) == 0) {
-        bit >>= 1;
+    while ((value & 1) == 0) {
+        value >>= 1;
         count++;
     }
-    return count;
+    return word * 64 + count;
 }
 
 #define FREECS_REGISTER(world, type) freecs_register_component(world, sizeof(type))
 
+#define FREECS_REGISTER_ALIGNED(world, type, align) freecs_register_component_aligned(world, sizeof(type), align)
+
 #define FREECS_GET(world, entity, type, bit) ((type*)freecs_get(world, entity, bit))
 
+#define FREECS_GET_MUT(world, entity, type, bit) ((type*)freecs_get_mut(world, entity, bit))
+
 #define FREECS_SET(world, entity, type, bit, value) \
     do { \
         type _val = (value); \
@@ -255,7 +652,19 @@ static inline size_t freecs_bit_index(uint64_t bit) {
         freecs_add_component(world, entity, bit, &_val, sizeof(type)); \
     } while(0)
 
+#ifdef FREECS_CHUNKED_STORAGE
+#define FREECS_FLAT_COLUMN_UNAVAILABLE(name) \
+    ((void*)sizeof(struct { _Static_assert(0, name " is unavailable with FREECS_CHUNKED_STORAGE, use FREECS_ITER_COLUMN or freecs_column_row"); int unused; }))
+#define freecs_column(arch, bit, out_count) FREECS_FLAT_COLUMN_UNAVAILABLE("freecs_column")
+#define freecs_column_unchecked(arch, bit) FREECS_FLAT_COLUMN_UNAVAILABLE("freecs_column_unchecked")
+#define FREECS_COLUMN(arch, type, bit) ((type*)FREECS_FLAT_COLUMN_UNAVAILABLE("FREECS_COLUMN"))
+#else
 #define FREECS_COLUMN(arch, type, bit) ((type*)freecs_column_unchecked(arch, bit))
+#endif
+
+#define FREECS_ITER_COLUMN(result, type, bit) ((type*)freecs_iter_column(result, bit))
+
+#define FREECS_ITER_COLUMN_MUT(world, result, type, bit) ((type*)freecs_iter_column_mut(world, result, bit))
 
 #define FREECS_CREATE_EVENT_QUEUE(type) freecs_create_event_queue(sizeof(type))
 
@@ -265,6 +674,14 @@ static inline size_t freecs_bit_index(uint64_t bit) {
         freecs_send_event(queue, &_ev); \
     } while(0)
 
+#define FREECS_PAR_SEND_EVENT(queue, type, event) \
+    do { \
+        type _ev = (event); \
+        freecs_par_send_event(queue, &_ev); \
+    } while(0)
+
 #define FREECS_READ_EVENTS(queue, type, out_count) ((type*)freecs_read_events(queue, out_count))
 
+#define FREECS_READ_NEW_EVENTS(queue, reader, type, out_count) ((type*)freecs_read_new_events(queue, reader, out_count))
+
 #endif
@@ -0,0 +1,1576 @@
+#include "freecs.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_WARMUP 2
+#define BENCH_REPETITIONS 15
+#define BENCH_DT (1.0f / 60.0f)
+#define CORE_ENTITIES 100000
+#define CORE_ARCHETYPES 64
+#define CORE_QUERIES 100000
+#define BOIDS_COUNT 20000
+#define BOIDS_TICKS 10
+#define BOIDS_WIDTH 1920.0f
+#define BOIDS_HEIGHT 1080.0f
+#define BOIDS_CELL 50.0f
+#define BOIDS_RANGE 50.0f
+#define BOIDS_MAX_NEIGHBORS 7
+#define TD_PATH_POINTS 12
+#define TD_TOWERS 64
+#define TD_SPAWNS_PER_TICK 20
+#define TD_TICKS 600
+#define LOOKUP_COMPONENTS 17
+#define LOOKUP_ITERATIONS 200000
+#define LOOKUP_MAX_QUERIES 10000
+#define PAR_ENTITIES 2000000
+#define PAR_ITERATIONS 10
+#define FLIP_ENTITIES 100000
+#define FLIP_TICKS 20
+#define WAVE_SPAWNS 10000
+#define WAVE_TICKS 50
+#define CLEAR_ENTITIES 50000
+#define CLEAR_TICKS 20
+#define INGEST_ENTITIES 1000000
+#define LOOKUP_ENTITIES 4000000
+#define RANDOM_LOOKUPS 4000000
+#define SPATIAL_ENTITIES 200000
+#define SPATIAL_EXTENT 4000.0f
+#define SPATIAL_CELL 32.0f
+#define SPATIAL_QUERIES 20000
+#define SPATIAL_BRUTE_QUERIES 200
+#define SPATIAL_RADIUS 32.0f
+#define SPATIAL_NEAREST 8
+#define CHANGE_ENTITIES 1000000
+#define CHANGE_ITERATIONS 20
+#define TAG_ENTITIES 500000
+#define TAG_LOOKUPS 1000000
+#define EVENT_PER_FRAME 20000
+#define EVENT_FRAMES 60
+#define EVENT_CONSUMERS 4
+#define EVENT_PRODUCER_ENTITIES 1000000
+
+typedef struct {
+    float x;
+    float y;
+} Vec2;
+
+static double now_ns(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static uint64_t rng_state = 0x9e3779b97f4a7c15ULL;
+
+static uint64_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static freecs_mask_t mask_from_pattern(size_t pattern) {
+    freecs_mask_t mask = FREECS_MASK_EMPTY;
+    for (size_t bit_idx = 0; pattern != 0; bit_idx++, pattern >>= 1) {
+        if (pattern & 1) mask = freecs_mask_or(mask, freecs_mask_bit(bit_idx));
+    }
+    return mask;
+}
+
+static size_t fill_entries(freecs_world_t* world, freecs_mask_t mask, freecs_type_info_entry_t* entries) {
+    size_t count = 0;
+    for (size_t bit_idx = 0; bit_idx < LOOKUP_COMPONENTS; bit_idx++) {
+        if (freecs_mask_test(mask, bit_idx)) {
+            entries[count++] = (freecs_type_info_entry_t){freecs_mask_bit(bit_idx), world->type_sizes[bit_idx], NULL, bit_idx};
+        }
+    }
+    return count;
+}
+
+typedef struct {
+    freecs_world_t world;
+    freecs_mask_t position;
+    freecs_mask_t velocity;
+    freecs_mask_t health;
+    freecs_entity_t* entities;
+    size_t count;
+    void* scenario;
+} BenchState;
+
+typedef struct {
+    const char* name;
+    size_t ops;
+    void (*setup)(BenchState* state);
+    size_t (*run)(BenchState* state);
+    void (*teardown)(BenchState* state);
+} BenchCase;
+
+static volatile size_t bench_sink;
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, size_t count, double p) {
+    size_t rank = (size_t)ceil(p * (double)count);
+    if (rank == 0) rank = 1;
+    return sorted[rank - 1];
+}
+
+static void run_case(const BenchCase* bench) {
+    double ns_per_op[BENCH_REPETITIONS];
+    double entities_per_sec[BENCH_REPETITIONS];
+    for (int rep = 0; rep < BENCH_WARMUP + BENCH_REPETITIONS; rep++) {
+        BenchState state;
+        memset(&state, 0, sizeof(state));
+        state.world = freecs_create_world();
+        state.position = freecs_register_component(&state.world, sizeof(Vec2));
+        state.velocity = freecs_register_component(&state.world, sizeof(Vec2));
+        state.health = freecs_register_component(&state.world, sizeof(float));
+        if (bench->setup != NULL) bench->setup(&state);
+
+        double start = now_ns();
+        size_t entities = bench->run(&state);
+        double elapsed = now_ns() - start;
+
+        if (bench->teardown != NULL) bench->teardown(&state);
+        free(state.entities);
+        freecs_destroy_world(&state.world);
+
+        if (rep >= BENCH_WARMUP) {
+            ns_per_op[rep - BENCH_WARMUP] = elapsed / (double)bench->ops;
+            entities_per_sec[rep - BENCH_WARMUP] = (double)entities * 1e9 / elapsed;
+        }
+    }
+
+    qsort(ns_per_op, BENCH_REPETITIONS, sizeof(double), compare_doubles);
+    qsort(entities_per_sec, BENCH_REPETITIONS, sizeof(double), compare_doubles);
+    printf("  %-24s | p50 %11.1f | p90 %11.1f | p99 %11.1f ns/op",
+           bench->name,
+           percentile(ns_per_op, BENCH_REPETITIONS, 0.50),
+           percentile(ns_per_op, BENCH_REPETITIONS, 0.90),
+           percentile(ns_per_op, BENCH_REPETITIONS, 0.99));
+    double throughput = percentile(entities_per_sec, BENCH_REPETITIONS, 0.50);
+    if (throughput > 0.0) {
+        printf(" | %8.2f M entities/s", throughput / 1e6);
+    }
+    printf("\n");
+}
+
+static size_t run_spawn(BenchState* state) {
+    Vec2 position = {1.0f, 2.0f};
+    Vec2 velocity = {0.5f, 0.5f};
+    freecs_type_info_entry_t entries[2] = {
+        {state->position, sizeof(Vec2), &position, freecs_bit_index(state->position)},
+        {state->velocity, sizeof(Vec2), &velocity, freecs_bit_index(state->velocity)}
+    };
+    for (size_t i = 0; i < CORE_ENTITIES; i++) {
+        freecs_spawn(&state->world, freecs_mask_or(state->position, state->velocity), entries, 2);
+    }
+    return CORE_ENTITIES;
+}
+
+static size_t run_spawn_batch(BenchState* state) {
+    state->entities = freecs_spawn_batch(&state->world, freecs_mask_or(state->position, state->velocity), CORE_ENTITIES, &state->count);
+    return state->count;
+}
+
+static void setup_spawned(BenchState* state) {
+    state->entities = freecs_spawn_batch(&state->world, freecs_mask_or(state->position, state->velocity), CORE_ENTITIES, &state->count);
+}
+
+static void setup_shuffled(BenchState* state) {
+    setup_spawned(state);
+    for (size_t i = state->count; i > 1; i--) {
+        size_t j = rng_next() % i;
+        freecs_entity_t tmp = state->entities[i - 1];
+        state->entities[i - 1] = state->entities[j];
+        state->entities[j] = tmp;
+    }
+}
+
+static size_t run_despawn(BenchState* state) {
+    for (size_t i = 0; i < state->count; i++) {
+        freecs_despawn(&state->world, state->entities[i]);
+    }
+    return state->count;
+}
+
+static size_t run_despawn_batch(BenchState* state) {
+    return freecs_despawn_batch(&state->world, state->entities, state->count);
+}
+
+static size_t run_add_component(BenchState* state) {
+    float health = 100.0f;
+    for (size_t i = 0; i < state->count; i++) {
+        freecs_add_component(&state->world, state->entities[i], state->health, &health, sizeof(float));
+    }
+    return state->count;
+}
+
+static void setup_with_health(BenchState* state) {
+    state->entities = freecs_spawn_batch(&state->world, freecs_mask_or(freecs_mask_or(state->position, state->velocity), state->health), CORE_ENTITIES, &state->count);
+}
+
+static size_t run_remove_component(BenchState* state) {
+    for (size_t i = 0; i < state->count; i++) {
+        freecs_remove_component(&state->world, state->entities[i], state->health);
+    }
+    return state->count;
+}
+
+static size_t run_get(BenchState* state) {
+    float total = 0.0f;
+    for (size_t i = 0; i < state->count; i++) {
+        Vec2* position = freecs_get(&state->world, state->entities[i], state->position);
+        total += position->x;
+    }
+    bench_sink = (size_t)total;
+    return state->count;
+}
+
+static void setup_archetypes(BenchState* state) {
+    for (size_t i = 0; i < 16; i++) {
+        freecs_register_component(&state->world, 0);
+    }
+    for (size_t i = 0; i < CORE_ARCHETYPES; i++) {
+        freecs_mask_t mask = freecs_mask_or(freecs_mask_or(state->position, freecs_mask_bit(3 + i % 8)), freecs_mask_bit(11 + i / 8));
+        size_t count;
+        free(freecs_spawn_batch(&state->world, mask, CORE_ENTITIES / CORE_ARCHETYPES, &count));
+    }
+}
+
+static size_t run_query(BenchState* state) {
+    size_t total = 0;
+    for (size_t i = 0; i < CORE_QUERIES; i++) {
+        total += freecs_query_count(&state->world, freecs_mask_or(state->position, freecs_mask_bit(3 + i % 8)), FREECS_MASK_EMPTY);
+    }
+    bench_sink = total;
+    return 0;
+}
+
+static size_t run_table_iterator(BenchState* state) {
+    size_t total = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(&state->world, freecs_mask_or(state->position, state->velocity), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&result, Vec2, state->position);
+        Vec2* velocities = FREECS_ITER_COLUMN(&result, Vec2, state->velocity);
+        for (size_t i = 0; i < result.row_count; i++) {
+            positions[i].x += velocities[i].x * 0.016f;
+            positions[i].y += velocities[i].y * 0.016f;
+        }
+        total += result.row_count;
+    }
+    return total;
+}
+
+static size_t run_command_spawns(BenchState* state) {
+    freecs_command_buffer_t buffer = freecs_create_command_buffer(&state->world);
+    Vec2 position = {1.0f, 2.0f};
+    freecs_type_info_entry_t entries[1] = {{state->position, sizeof(Vec2), &position, freecs_bit_index(state->position)}};
+    for (size_t i = 0; i < CORE_ENTITIES; i++) {
+        freecs_queue_spawn(&buffer, state->position, entries, 1);
+    }
+    freecs_apply_commands(&buffer);
+    freecs_destroy_command_buffer(&buffer);
+    return CORE_ENTITIES;
+}
+
+static void bench_core(void) {
+    BenchCase cases[] = {
+        {"spawn", CORE_ENTITIES, NULL, run_spawn, NULL},
+        {"spawn_batch", CORE_ENTITIES, NULL, run_spawn_batch, NULL},
+        {"despawn", CORE_ENTITIES, setup_shuffled, run_despawn, NULL},
+        {"despawn_batch", CORE_ENTITIES, setup_shuffled, run_despawn_batch, NULL},
+        {"add_component", CORE_ENTITIES, setup_spawned, run_add_component, NULL},
+        {"remove_component", CORE_ENTITIES, setup_with_health, run_remove_component, NULL},
+        {"get (random)", CORE_ENTITIES, setup_shuffled, run_get, NULL},
+        {"query_count", CORE_QUERIES, setup_archetypes, run_query, NULL},
+        {"table iteration", CORE_ENTITIES, setup_spawned, run_table_iterator, NULL},
+        {"queued spawn + apply", CORE_ENTITIES, NULL, run_command_spawns, NULL}
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        run_case(&cases[i]);
+    }
+}
+
+static void bench_archetype_lookup(size_t archetype_count) {
+    freecs_world_t world = freecs_create_world();
+    for (size_t i = 0; i < LOOKUP_COMPONENTS; i++) {
+        freecs_register_component(&world, sizeof(uint32_t));
+    }
+
+    freecs_type_info_entry_t entries[LOOKUP_COMPONENTS];
+    double start = now_ns();
+    for (size_t i = 0; i < archetype_count; i++) {
+        freecs_mask_t mask = mask_from_pattern(i + 1);
+        size_t entry_count = fill_entries(&world, mask, entries);
+        freecs_spawn(&world, mask, entries, entry_count);
+    }
+    double create_ns = (now_ns() - start) / (double)archetype_count;
+
+    freecs_mask_t* masks = malloc(LOOKUP_ITERATIONS * sizeof(freecs_mask_t));
+    for (size_t i = 0; i < LOOKUP_ITERATIONS; i++) {
+        masks[i] = mask_from_pattern((rng_next() % archetype_count) + 1);
+    }
+
+    start = now_ns();
+    for (size_t i = 0; i < LOOKUP_ITERATIONS; i++) {
+        freecs_mask_t mask = masks[i];
+        size_t entry_count = fill_entries(&world, mask, entries);
+        freecs_spawn(&world, mask, entries, entry_count);
+    }
+    double spawn_ns = (now_ns() - start) / LOOKUP_ITERATIONS;
+
+    size_t query_count = archetype_count < LOOKUP_MAX_QUERIES ? archetype_count : LOOKUP_MAX_QUERIES;
+    for (size_t i = 0; i < query_count; i++) {
+        size_t matching_count;
+        freecs_get_matching_archetypes(&world, mask_from_pattern(i + 1), FREECS_MASK_EMPTY, &matching_count);
+    }
+
+    for (size_t i = 0; i < LOOKUP_ITERATIONS; i++) {
+        masks[i] = mask_from_pattern((rng_next() % query_count) + 1);
+    }
+
+    start = now_ns();
+    size_t checksum = 0;
+    for (size_t i = 0; i < LOOKUP_ITERATIONS; i++) {
+        size_t matching_count;
+        freecs_get_matching_archetypes(&world, masks[i], FREECS_MASK_EMPTY, &matching_count);
+        checksum += matching_count;
+    }
+    double query_ns = (now_ns() - start) / LOOKUP_ITERATIONS;
+
+    printf("  %8zu archetypes | create: %8.1f ns/op | spawn into existing: %8.1f ns/op | cached query: %8.1f ns/op | (%zu)\n",
+           archetype_count, create_ns, spawn_ns, query_ns, checksum);
+
+    free(masks);
+    freecs_destroy_world(&world);
+}
+
+static freecs_mask_t BIT_PAR_POSITION;
+static freecs_mask_t BIT_PAR_VELOCITY;
+
+static void integrate_rows(Vec2* positions, Vec2* velocities, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        float speed = sqrtf(velocities[i].x * velocities[i].x + velocities[i].y * velocities[i].y);
+        float scale = speed > 1.0f ? 1.0f / speed : 1.0f;
+        velocities[i].x *= scale;
+        velocities[i].y *= scale;
+        positions[i].x += velocities[i].x * 0.016f;
+        positions[i].y += velocities[i].y * 0.016f;
+    }
+}
+
+static void integrate_table(freecs_archetype_t* arch) {
+#ifdef FREECS_CHUNKED_STORAGE
+    for (size_t row = 0; row < arch->entities_len; row += arch->chunk_rows) {
+        size_t rows = arch->entities_len - row < arch->chunk_rows ? arch->entities_len - row : arch->chunk_rows;
+        integrate_rows(freecs_column_row(arch, BIT_PAR_POSITION, row), freecs_column_row(arch, BIT_PAR_VELOCITY, row), rows);
+    }
+#else
+    integrate_rows(FREECS_COLUMN(arch, Vec2, BIT_PAR_POSITION), FREECS_COLUMN(arch, Vec2, BIT_PAR_VELOCITY), arch->entities_len);
+#endif
+}
+
+static void integrate_view(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    (void)thread_index;
+    (void)user;
+    integrate_rows(FREECS_ITER_COLUMN(view, Vec2, BIT_PAR_POSITION), FREECS_ITER_COLUMN(view, Vec2, BIT_PAR_VELOCITY), view->row_count);
+}
+
+static void bench_parallel(void) {
+    freecs_world_t world = freecs_create_world();
+    BIT_PAR_POSITION = FREECS_REGISTER_ALIGNED(&world, Vec2, 32);
+    BIT_PAR_VELOCITY = FREECS_REGISTER_ALIGNED(&world, Vec2, 32);
+    freecs_mask_t BIT_TAG_A = freecs_register_component(&world, sizeof(uint32_t));
+    freecs_mask_t BIT_TAG_B = freecs_register_component(&world, sizeof(uint32_t));
+
+    freecs_mask_t base = freecs_mask_or(BIT_PAR_POSITION, BIT_PAR_VELOCITY);
+    freecs_mask_t masks[3] = {base, freecs_mask_or(base, BIT_TAG_A), freecs_mask_or(base, BIT_TAG_B)};
+    size_t counts[3] = {PAR_ENTITIES * 8 / 10, PAR_ENTITIES * 15 / 100, PAR_ENTITIES * 5 / 100};
+    for (size_t a = 0; a < 3; a++) {
+        size_t spawned;
+        freecs_entity_t* entities = freecs_spawn_batch(&world, masks[a], counts[a], &spawned);
+        for (size_t i = 0; i < spawned; i++) {
+            Vec2* velocity = freecs_get(&world, entities[i], BIT_PAR_VELOCITY);
+            velocity->x = (float)(rng_next() % 200) / 100.0f - 1.0f;
+            velocity->y = (float)(rng_next() % 200) / 100.0f - 1.0f;
+        }
+        free(entities);
+    }
+
+    freecs_for_each_table(&world, base, FREECS_MASK_EMPTY, integrate_table);
+    double start = now_ns();
+    for (int i = 0; i < PAR_ITERATIONS; i++) {
+        freecs_for_each_table(&world, base, FREECS_MASK_EMPTY, integrate_table);
+    }
+    double serial_ns = (now_ns() - start) / PAR_ITERATIONS;
+    printf("  %-20s | %8.3f ms/iter | %6.2f ns/entity\n", "serial", serial_ns / 1e6, serial_ns / PAR_ENTITIES);
+
+    size_t thread_counts[] = {1, 2, 4, 8};
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        freecs_thread_pool_t* pool = freecs_create_thread_pool(thread_counts[t]);
+        freecs_par_for_each_table(pool, &world, base, FREECS_MASK_EMPTY, integrate_view, NULL);
+        double par_start = now_ns();
+        for (int i = 0; i < PAR_ITERATIONS; i++) {
+            freecs_par_for_each_table(pool, &world, base, FREECS_MASK_EMPTY, integrate_view, NULL);
+        }
+        double par_ns = (now_ns() - par_start) / PAR_ITERATIONS;
+        char label[32];
+        snprintf(label, sizeof(label), "parallel, %zu threads", thread_counts[t]);
+        printf("  %-20s | %8.3f ms/iter | %6.2f ns/entity | speedup %.2fx\n", label, par_ns / 1e6, par_ns / PAR_ENTITIES, serial_ns / par_ns);
+        freecs_destroy_thread_pool(pool);
+    }
+
+    freecs_destroy_world(&world);
+}
+
+static void bench_command_flips(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_VEL = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_STUNNED = freecs_register_component(&world, sizeof(uint32_t));
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POS, BIT_VEL), FLIP_ENTITIES, &count);
+
+    uint32_t stunned = 1;
+    double start = now_ns();
+    for (int tick = 0; tick < FLIP_TICKS; tick++) {
+        for (size_t i = 0; i < count; i++) {
+            if (tick % 2 == 0) {
+                freecs_add_component(&world, entities[i], BIT_STUNNED, &stunned, sizeof(uint32_t));
+            } else {
+                freecs_remove_component(&world, entities[i], BIT_STUNNED);
+            }
+        }
+    }
+    double direct_ns = (now_ns() - start) / ((double)FLIP_TICKS * count);
+
+    freecs_command_buffer_t buffer = freecs_create_command_buffer(&world);
+    freecs_type_info_entry_t payload[1] = {{BIT_STUNNED, sizeof(uint32_t), &stunned, freecs_bit_index(BIT_STUNNED)}};
+    double record_ns = 0.0;
+    double apply_ns = 0.0;
+    for (int tick = 0; tick < FLIP_TICKS; tick++) {
+        start = now_ns();
+        for (size_t i = 0; i < count; i++) {
+            if (tick % 2 == 0) {
+                freecs_queue_add_components_with_data(&buffer, entities[i], BIT_STUNNED, payload, 1);
+            } else {
+                freecs_queue_remove_components(&buffer, entities[i], BIT_STUNNED);
+            }
+        }
+        double mid = now_ns();
+        freecs_apply_commands(&buffer);
+        record_ns += mid - start;
+        apply_ns += now_ns() - mid;
+    }
+    record_ns /= (double)FLIP_TICKS * count;
+    apply_ns /= (double)FLIP_TICKS * count;
+
+    printf("  direct add/remove    | %6.1f ns/flip\n", direct_ns);
+    printf("  command buffer       | %6.1f ns/flip (record %.1f + apply %.1f)\n", record_ns + apply_ns, record_ns, apply_ns);
+
+    freecs_destroy_command_buffer(&buffer);
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
+static void bench_command_spawns(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_VEL = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_HP = freecs_register_component(&world, sizeof(float));
+
+    freecs_command_buffer_t buffer = freecs_create_command_buffer(&world);
+    Vec2 pos = {1.0f, 2.0f};
+    Vec2 vel = {0.5f, 0.5f};
+    float hp = 100.0f;
+    freecs_type_info_entry_t entries[3] = {
+        {BIT_POS, sizeof(Vec2), &pos, freecs_bit_index(BIT_POS)},
+        {BIT_VEL, sizeof(Vec2), &vel, freecs_bit_index(BIT_VEL)},
+        {BIT_HP, sizeof(float), &hp, freecs_bit_index(BIT_HP)}
+    };
+    freecs_mask_t mask = freecs_mask_or(freecs_mask_or(BIT_POS, BIT_VEL), BIT_HP);
+
+    double record_ns = 0.0;
+    double apply_ns = 0.0;
+    for (int tick = 0; tick < WAVE_TICKS; tick++) {
+        double start = now_ns();
+        for (int i = 0; i < WAVE_SPAWNS; i++) {
+            freecs_queue_spawn(&buffer, mask, entries, 3);
+        }
+        double mid = now_ns();
+        freecs_apply_commands(&buffer);
+        record_ns += mid - start;
+        apply_ns += now_ns() - mid;
+    }
+    record_ns /= (double)WAVE_TICKS * WAVE_SPAWNS;
+    apply_ns /= (double)WAVE_TICKS * WAVE_SPAWNS;
+
+    printf("  queued spawns        | %6.1f ns/spawn (record %.1f + apply %.1f)\n", record_ns + apply_ns, record_ns, apply_ns);
+
+    freecs_destroy_command_buffer(&buffer);
+    freecs_destroy_world(&world);
+}
+
+static void bench_wave_clear(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_VEL = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_HP = freecs_register_component(&world, sizeof(float));
+    freecs_mask_t masks[2] = {freecs_mask_or(freecs_mask_or(BIT_POS, BIT_VEL), BIT_HP), freecs_mask_or(BIT_POS, BIT_HP)};
+
+    freecs_entity_t* victims = malloc(CLEAR_ENTITIES * sizeof(freecs_entity_t));
+    double per_entity_ns = 0.0;
+    double batch_ns = 0.0;
+    double spawn_ns = 0.0;
+    double lookup_ns = 0.0;
+    for (int tick = 0; tick < CLEAR_TICKS; tick++) {
+        for (int pass = 0; pass < 2; pass++) {
+            size_t count = 0;
+            double spawn_start = now_ns();
+            for (int a = 0; a < 2; a++) {
+                size_t spawned;
+                freecs_entity_t* entities = freecs_spawn_batch(&world, masks[a], CLEAR_ENTITIES / 2, &spawned);
+                memcpy(&victims[count], entities, spawned * sizeof(freecs_entity_t));
+                count += spawned;
+                free(entities);
+            }
+            spawn_ns += now_ns() - spawn_start;
+
+            double lookup_start = now_ns();
+            for (size_t i = 0; i < count; i++) {
+                float* hp = freecs_get(&world, victims[i], BIT_HP);
+                *hp += 1.0f;
+            }
+            lookup_ns += now_ns() - lookup_start;
+            for (size_t i = count; i > 1; i--) {
+                size_t j = rng_next() % i;
+                freecs_entity_t tmp = victims[i - 1];
+                victims[i - 1] = victims[j];
+                victims[j] = tmp;
+            }
+
+            double start = now_ns();
+            if (pass == 0) {
+                for (size_t i = 0; i < count; i++) {
+                    freecs_despawn(&world, victims[i]);
+                }
+                per_entity_ns += now_ns() - start;
+            } else {
+                freecs_despawn_batch(&world, victims, count);
+                batch_ns += now_ns() - start;
+            }
+        }
+    }
+    per_entity_ns /= (double)CLEAR_TICKS * CLEAR_ENTITIES;
+    batch_ns /= (double)CLEAR_TICKS * CLEAR_ENTITIES;
+    spawn_ns /= 2.0 * CLEAR_TICKS * CLEAR_ENTITIES;
+    lookup_ns /= 2.0 * CLEAR_TICKS * CLEAR_ENTITIES;
+
+    printf("  freecs_despawn       | %6.1f ns/entity\n", per_entity_ns);
+    printf("  freecs_despawn_batch | %6.1f ns/entity\n", batch_ns);
+    printf("  respawn wave         | %6.1f ns/entity\n", spawn_ns);
+    printf("  get in spawn order   | %6.1f ns/entity\n", lookup_ns);
+
+    free(victims);
+    freecs_destroy_world(&world);
+}
+
+static Vec2* ingest_positions;
+static float* ingest_health;
+
+static void ingest_init(freecs_archetype_t* arch, size_t row) {
+    memcpy(freecs_column_row(arch, arch->columns[0].bit, row), &ingest_positions[row], sizeof(Vec2));
+    memcpy(freecs_column_row(arch, arch->columns[2].bit, row), &ingest_health[row], sizeof(float));
+}
+
+static void bench_ingest(void) {
+    ingest_positions = malloc(INGEST_ENTITIES * sizeof(Vec2));
+    ingest_health = malloc(INGEST_ENTITIES * sizeof(float));
+    for (size_t i = 0; i < INGEST_ENTITIES; i++) {
+        ingest_positions[i] = (Vec2){(float)i, (float)(i * 2)};
+        ingest_health[i] = (float)(i % 100);
+    }
+
+    const char* labels[2] = {"spawn_with_init", "spawn_batch_columns"};
+    for (int pass = 0; pass < 2; pass++) {
+        freecs_world_t world = freecs_create_world();
+        freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+        freecs_mask_t BIT_VEL = freecs_register_component(&world, sizeof(Vec2));
+        freecs_mask_t BIT_HP = freecs_register_component(&world, sizeof(float));
+        freecs_mask_t mask = freecs_mask_or(freecs_mask_or(BIT_POS, BIT_VEL), BIT_HP);
+
+        size_t count;
+        double start = now_ns();
+        freecs_entity_t* entities;
+        if (pass == 0) {
+            entities = freecs_spawn_with_init(&world, mask, INGEST_ENTITIES, ingest_init, &count);
+        } else {
+            const void* sources[3] = {ingest_positions, NULL, ingest_health};
+            entities = freecs_spawn_batch_columns(&world, mask, INGEST_ENTITIES, sources, &count);
+        }
+        double elapsed = now_ns() - start;
+
+        printf("  %-20s | %6.1f ns/entity\n", labels[pass], elapsed / INGEST_ENTITIES);
+
+        free(entities);
+        freecs_destroy_world(&world);
+    }
+
+    free(ingest_positions);
+    free(ingest_health);
+}
+
+static void bench_random_get(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_HP = freecs_register_component(&world, sizeof(float));
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POS, BIT_HP), LOOKUP_ENTITIES, &count);
+    freecs_entity_t* lookups = malloc(RANDOM_LOOKUPS * sizeof(freecs_entity_t));
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        lookups[i] = entities[rng_next() % count];
+    }
+
+    double start = now_ns();
+    float total = 0.0f;
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        float* hp = freecs_get(&world, lookups[i], BIT_HP);
+        total += *hp;
+    }
+    double get_ns = (now_ns() - start) / RANDOM_LOOKUPS;
+
+    start = now_ns();
+    size_t alive = 0;
+    for (size_t i = 0; i < RANDOM_LOOKUPS; i++) {
+        alive += freecs_is_alive(&world, lookups[i]);
+    }
+    double alive_ns = (now_ns() - start) / RANDOM_LOOKUPS;
+
+    printf("  location slot        | %zu bytes\n", sizeof(freecs_entity_location_t));
+    printf("  freecs_get           | %6.1f ns/lookup\n", get_ns);
+    printf("  freecs_is_alive      | %6.1f ns/lookup\n", alive_ns);
+    if (total < 0.0f || alive != RANDOM_LOOKUPS) printf("unexpected\n");
+
+    free(lookups);
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
+static float rng_unit(void) {
+    return (float)(rng_next() >> 40) / (float)(1u << 24);
+}
+
+static void bench_spatial(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POS, SPATIAL_ENTITIES, &count);
+    for (size_t i = 0; i < count; i++) {
+        Vec2* pos = freecs_get(&world, entities[i], BIT_POS);
+        *pos = (Vec2){rng_unit() * SPATIAL_EXTENT, rng_unit() * SPATIAL_EXTENT};
+    }
+
+    freecs_spatial_index_t index = freecs_create_spatial_index(&world, BIT_POS, SPATIAL_CELL, SPATIAL_ENTITIES / 4);
+    double start = now_ns();
+    freecs_spatial_update(&index, 0);
+    double build_ns = (now_ns() - start) / count;
+
+    for (size_t i = 0; i < count; i += 10) {
+        Vec2* pos = freecs_get(&world, entities[i], BIT_POS);
+        pos->x += (rng_unit() - 0.5f) * SPATIAL_CELL;
+        pos->y += (rng_unit() - 0.5f) * SPATIAL_CELL;
+    }
+    start = now_ns();
+    freecs_spatial_update(&index, 0);
+    double update_ns = (now_ns() - start) / count;
+
+    Vec2* probes = malloc(SPATIAL_QUERIES * sizeof(Vec2));
+    for (size_t i = 0; i < SPATIAL_QUERIES; i++) {
+        probes[i] = (Vec2){rng_unit() * SPATIAL_EXTENT, rng_unit() * SPATIAL_EXTENT};
+    }
+
+    freecs_entity_t hits[256];
+    size_t found = 0;
+    start = now_ns();
+    for (size_t i = 0; i < SPATIAL_QUERIES; i++) {
+        found += freecs_spatial_query_radius(&index, probes[i].x, probes[i].y, SPATIAL_RADIUS, hits, 256);
+    }
+    double radius_ns = (now_ns() - start) / SPATIAL_QUERIES;
+
+    size_t nearest = 0;
+    start = now_ns();
+    for (size_t i = 0; i < SPATIAL_QUERIES; i++) {
+        nearest += freecs_spatial_query_nearest(&index, probes[i].x, probes[i].y, SPATIAL_NEAREST, 0.0f, hits);
+    }
+    double nearest_ns = (now_ns() - start) / SPATIAL_QUERIES;
+
+    freecs_track_changes(&world, BIT_POS);
+    freecs_spatial_update(&index, 0);
+    uint32_t since = freecs_advance_tick(&world);
+    for (size_t i = 0; i < count; i += 100) {
+        Vec2* pos = freecs_get_mut(&world, entities[i], BIT_POS);
+        pos->x += (rng_unit() - 0.5f) * SPATIAL_CELL;
+        pos->y += (rng_unit() - 0.5f) * SPATIAL_CELL;
+    }
+    start = now_ns();
+    freecs_spatial_update(&index, since);
+    double tracked_ns = (now_ns() - start) / count;
+
+    size_t brute = 0;
+    start = now_ns();
+    for (size_t q = 0; q < SPATIAL_BRUTE_QUERIES; q++) {
+        freecs_table_iterator_t iter = freecs_table_iterator(&world, BIT_POS, FREECS_MASK_EMPTY);
+        freecs_table_iterator_result_t view;
+        while (freecs_table_iterator_next(&iter, &view)) {
+            Vec2* positions = FREECS_ITER_COLUMN(&view, Vec2, BIT_POS);
+            for (size_t i = 0; i < view.row_count; i++) {
+                float dx = positions[i].x - probes[q].x;
+                float dy = positions[i].y - probes[q].y;
+                brute += dx * dx + dy * dy <= SPATIAL_RADIUS * SPATIAL_RADIUS;
+            }
+        }
+    }
+    double brute_ns = (now_ns() - start) / SPATIAL_BRUTE_QUERIES;
+
+    printf("  initial build        | %8.1f ns/entity\n", build_ns);
+    printf("  update, 10%% moved    | %8.1f ns/entity\n", update_ns);
+    printf("  tracked, 1%% moved    | %8.1f ns/entity\n", tracked_ns);
+    printf("  radius query         | %8.1f ns/query (%.1f hits)\n", radius_ns, (double)found / SPATIAL_QUERIES);
+    printf("  nearest query        | %8.1f ns/query (k = %d)\n", nearest_ns, SPATIAL_NEAREST);
+    printf("  brute-force radius   | %8.1f ns/query\n", brute_ns);
+    if (nearest != (size_t)SPATIAL_QUERIES * SPATIAL_NEAREST || brute == (size_t)-1) printf("unexpected\n");
+
+    free(probes);
+    free(entities);
+    freecs_destroy_spatial_index(&index);
+    freecs_destroy_world(&world);
+}
+
+static double scan_positions(freecs_table_iterator_t* iter, freecs_mask_t bit, size_t* rows) {
+    double start = now_ns();
+    float total = 0.0f;
+    freecs_table_iterator_result_t view;
+    while (freecs_table_iterator_next(iter, &view)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&view, Vec2, bit);
+        for (size_t i = 0; i < view.row_count; i++) {
+            total += positions[i].x;
+        }
+        *rows += view.row_count;
+    }
+    bench_sink = (size_t)total;
+    return now_ns() - start;
+}
+
+static void bench_changes(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_VEL = freecs_register_component(&world, sizeof(Vec2));
+    freecs_track_changes(&world, BIT_POS);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POS, BIT_VEL), CHANGE_ENTITIES, &count);
+    const char* names[] = {"0.1% scattered", "1% scattered", "10% scattered", "1% clustered"};
+    size_t strides[] = {1000, 100, 10, 1};
+
+    for (size_t p = 0; p < sizeof(strides) / sizeof(strides[0]); p++) {
+        double full_ns = 0.0;
+        double changed_ns = 0.0;
+        size_t full_rows = 0;
+        size_t changed_rows = 0;
+
+        for (size_t iteration = 0; iteration < CHANGE_ITERATIONS; iteration++) {
+            uint32_t since = freecs_advance_tick(&world);
+            size_t first = strides[p] == 1 ? rng_next() % (count - count / 100) : rng_next() % strides[p];
+            size_t last = strides[p] == 1 ? first + count / 100 : count;
+            for (size_t i = first; i < last; i += strides[p]) {
+                ((Vec2*)freecs_get_mut(&world, entities[i], BIT_POS))->x += 1.0f;
+            }
+
+            freecs_table_iterator_t iter = freecs_table_iterator(&world, BIT_POS, FREECS_MASK_EMPTY);
+            full_ns += scan_positions(&iter, BIT_POS, &full_rows);
+            iter = freecs_query_changed(&world, BIT_POS, since);
+            changed_ns += scan_positions(&iter, BIT_POS, &changed_rows);
+        }
+
+        printf("  %-20s | full scan %7.1f us | changed %7.1f us (%zu rows)\n", names[p],
+               full_ns / CHANGE_ITERATIONS / 1000.0, changed_ns / CHANGE_ITERATIONS / 1000.0, changed_rows / CHANGE_ITERATIONS);
+        if (full_rows != count * CHANGE_ITERATIONS) printf("unexpected\n");
+    }
+
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
+static void bench_tags(void) {
+    freecs_tags_t tags = freecs_create_tags();
+    int tag_burning = freecs_register_tag(&tags, "burning");
+    int tag_frozen = freecs_register_tag(&tags, "frozen");
+
+    freecs_entity_t* entities = malloc(TAG_ENTITIES * sizeof(freecs_entity_t));
+    for (size_t i = 0; i < TAG_ENTITIES; i++) {
+        entities[i] = (freecs_entity_t){(uint32_t)(i * 2), 0};
+    }
+    freecs_entity_t* lookups = malloc(TAG_LOOKUPS * sizeof(freecs_entity_t));
+    for (size_t i = 0; i < TAG_LOOKUPS; i++) {
+        lookups[i] = (freecs_entity_t){(uint32_t)(rng_next() % (TAG_ENTITIES * 2)), 0};
+    }
+
+    double start = now_ns();
+    for (size_t i = 0; i < TAG_ENTITIES; i++) {
+        freecs_add_tag(&tags, tag_burning, entities[i]);
+    }
+    double add_ns = (now_ns() - start) / TAG_ENTITIES;
+
+    start = now_ns();
+    size_t hits = 0;
+    for (size_t i = 0; i < TAG_LOOKUPS; i++) {
+        hits += freecs_has_tag(&tags, tag_burning, lookups[i]);
+    }
+    double has_ns = (now_ns() - start) / TAG_LOOKUPS;
+
+    start = now_ns();
+    for (size_t i = 0; i < TAG_ENTITIES; i += 2) {
+        freecs_remove_tag(&tags, tag_burning, entities[i]);
+    }
+    double remove_ns = (now_ns() - start) / (TAG_ENTITIES / 2);
+
+    start = now_ns();
+    for (size_t i = 1; i < TAG_ENTITIES; i += 2) {
+        freecs_clear_entity_tags(&tags, entities[i]);
+    }
+    double clear_ns = (now_ns() - start) / (TAG_ENTITIES / 2);
+
+    printf("  freecs_add_tag       | %8.1f ns/op\n", add_ns);
+    printf("  freecs_has_tag       | %8.1f ns/op\n", has_ns);
+    printf("  freecs_remove_tag    | %8.1f ns/op\n", remove_ns);
+    printf("  clear_entity_tags    | %8.1f ns/op\n", clear_ns);
+    if (hits == 0 || freecs_tag_count(&tags, tag_burning) != 0 || freecs_tag_count(&tags, tag_frozen) != 0) printf("unexpected\n");
+
+    free(lookups);
+    free(entities);
+    freecs_destroy_tags(&tags);
+}
+
+static double bench_tag_query_pass(freecs_world_t* world, freecs_tags_t* tags, freecs_mask_t mask, freecs_mask_t bit, int tag_id, int without_id, bool legacy, size_t* visited) {
+    double start = now_ns();
+    float total = 0.0f;
+    if (legacy) {
+        size_t count;
+        freecs_entity_t* tagged = freecs_query_tag(tags, tag_id, &count);
+        for (size_t i = 0; i < count; i++) {
+            if (freecs_has_tag(tags, without_id, tagged[i])) continue;
+            if (!freecs_has_components(world, tagged[i], mask)) continue;
+            Vec2* pos = freecs_get(world, tagged[i], bit);
+            total += pos->x;
+            (*visited)++;
+        }
+        free(tagged);
+    } else {
+        freecs_tag_query_t query = freecs_tag_query(world, tags, mask, FREECS_MASK_EMPTY, FREECS_TAG_BIT(tag_id), FREECS_TAG_BIT(without_id));
+        freecs_tag_query_result_t results[256];
+        size_t found;
+        while ((found = freecs_tag_query_fill(&query, results, 256)) > 0) {
+            for (size_t i = 0; i < found; i++) {
+                total += ((Vec2*)freecs_column_row(results[i].archetype, bit, results[i].row))->x;
+            }
+            *visited += found;
+        }
+    }
+    bench_sink = (size_t)total;
+    return now_ns() - start;
+}
+
+static void bench_tag_queries(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    freecs_mask_t BIT_ENEMY = freecs_register_component(&world, sizeof(float));
+    freecs_mask_t BIT_BOSS = freecs_register_component(&world, sizeof(float));
+    size_t count;
+    size_t boss_count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POS, BIT_ENEMY), TAG_ENTITIES, &count);
+    freecs_entity_t* bosses = freecs_spawn_batch(&world, freecs_mask_or(freecs_mask_or(BIT_POS, BIT_ENEMY), BIT_BOSS), TAG_ENTITIES / 100, &boss_count);
+
+    struct {
+        const char* label;
+        size_t stride;
+        freecs_mask_t mask;
+    } cases[] = {
+        {"1% burning, enemies", 100, freecs_mask_or(BIT_POS, BIT_ENEMY)},
+        {"50% burning, enemies", 2, freecs_mask_or(BIT_POS, BIT_ENEMY)},
+        {"50% burning, bosses", 2, freecs_mask_or(BIT_POS, BIT_BOSS)},
+    };
+    for (size_t c = 0; c < sizeof(cases) / sizeof(cases[0]); c++) {
+        freecs_tags_t tags = freecs_create_tags();
+        int tag_burning = freecs_register_tag(&tags, "burning");
+        int tag_frozen = freecs_register_tag(&tags, "frozen");
+        size_t stride = cases[c].stride;
+        for (size_t i = 0; i < count; i += stride) {
+            freecs_add_tag(&tags, tag_burning, entities[(i * 7919) % count]);
+            if (i % (stride * 3) == 0) freecs_add_tag(&tags, tag_frozen, entities[(i * 7919) % count]);
+        }
+        for (size_t i = 0; i < boss_count; i += stride) {
+            freecs_add_tag(&tags, tag_burning, bosses[i]);
+        }
+
+        size_t legacy_rows = 0;
+        size_t query_rows = 0;
+        double legacy_ns = 1e18;
+        double query_ns = 1e18;
+        for (size_t rep = 0; rep < BENCH_REPETITIONS; rep++) {
+            double ns = bench_tag_query_pass(&world, &tags, cases[c].mask, BIT_POS, tag_burning, tag_frozen, true, &legacy_rows);
+            if (ns < legacy_ns) legacy_ns = ns;
+            ns = bench_tag_query_pass(&world, &tags, cases[c].mask, BIT_POS, tag_burning, tag_frozen, false, &query_rows);
+            if (ns < query_ns) query_ns = ns;
+        }
+        printf("  %-22s | query_tag + get %8.1f us | freecs_tag_query_fill %8.1f us\n",
+               cases[c].label, legacy_ns / 1000.0, query_ns / 1000.0);
+        if (legacy_rows != query_rows) printf("unexpected\n");
+        freecs_destroy_tags(&tags);
+    }
+
+    free(bosses);
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
+typedef struct {
+    freecs_entity_t entity;
+    float x;
+    float y;
+    uint32_t reward;
+    uint32_t kind;
+} BenchDiedEvent;
+
+static uint64_t consume_died_events(const BenchDiedEvent* events, size_t count) {
+    uint64_t total = 0;
+    for (size_t i = 0; i < count; i++) {
+        total += events[i].reward + events[i].entity.id;
+    }
+    return total;
+}
+
+typedef struct {
+    freecs_event_queue_t* queue;
+    pthread_mutex_t* lock;
+} BenchEventSink;
+
+static void bench_send_locked(freecs_archetype_t* arch, size_t row, size_t thread_index, void* user) {
+    (void)thread_index;
+    BenchEventSink* sink = user;
+    BenchDiedEvent event = {arch->entities[row], 0.0f, 0.0f, 1, 0};
+    pthread_mutex_lock(sink->lock);
+    freecs_send_event(sink->queue, &event);
+    pthread_mutex_unlock(sink->lock);
+}
+
+static void bench_send_par(freecs_archetype_t* arch, size_t row, size_t thread_index, void* user) {
+    (void)thread_index;
+    BenchEventSink* sink = user;
+    BenchDiedEvent event = {arch->entities[row], 0.0f, 0.0f, 1, 0};
+    freecs_par_send_event(sink->queue, &event);
+}
+
+static void bench_send_batched(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    (void)thread_index;
+    BenchEventSink* sink = user;
+    BenchDiedEvent events[256];
+    for (size_t start = 0; start < view->row_count; start += 256) {
+        size_t count = view->row_count - start < 256 ? view->row_count - start : 256;
+        for (size_t i = 0; i < count; i++) {
+            events[i] = (BenchDiedEvent){view->archetype->entities[view->row_start + start + i], 0.0f, 0.0f, 1, 0};
+        }
+        freecs_par_send_events(sink->queue, events, count);
+    }
+}
+
+static void bench_event_producers(void) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t BIT_POS = freecs_register_component(&world, sizeof(Vec2));
+    size_t count;
+    free(freecs_spawn_batch(&world, BIT_POS, EVENT_PRODUCER_ENTITIES, &count));
+    pthread_mutex_t lock;
+    pthread_mutex_init(&lock, NULL);
+
+    size_t thread_counts[] = {1, 4, 8};
+    for (size_t t = 0; t < sizeof(thread_counts) / sizeof(thread_counts[0]); t++) {
+        freecs_thread_pool_t* pool = freecs_create_thread_pool(thread_counts[t]);
+        freecs_event_queue_t queue = FREECS_CREATE_EVENT_QUEUE(BenchDiedEvent);
+        BenchEventSink sink = {&queue, &lock};
+
+        double locked_ns = 1e18;
+        double par_ns = 1e18;
+        double batch_ns = 1e18;
+        for (size_t rep = 0; rep < 5; rep++) {
+            double start = now_ns();
+            freecs_par_for_each(pool, &world, BIT_POS, FREECS_MASK_EMPTY, bench_send_locked, &sink);
+            double ns = now_ns() - start;
+            if (ns < locked_ns) locked_ns = ns;
+            if (freecs_event_count(&queue) != count) printf("unexpected\n");
+            freecs_clear_events(&queue);
+
+            start = now_ns();
+            freecs_par_for_each(pool, &world, BIT_POS, FREECS_MASK_EMPTY, bench_send_par, &sink);
+            ns = now_ns() - start;
+            if (ns < par_ns) par_ns = ns;
+            if (freecs_event_count(&queue) != count) printf("unexpected\n");
+            freecs_clear_events(&queue);
+
+            start = now_ns();
+            freecs_par_for_each_table(pool, &world, BIT_POS, FREECS_MASK_EMPTY, bench_send_batched, &sink);
+            ns = now_ns() - start;
+            if (ns < batch_ns) batch_ns = ns;
+            if (freecs_event_count(&queue) != count) printf("unexpected\n");
+            freecs_clear_events(&queue);
+        }
+        printf("  %zu thread%s %*s| mutex + send %6.1f ms | par_send_event %6.1f ms | par_send_events %6.1f ms\n",
+               thread_counts[t], thread_counts[t] == 1 ? " " : "s", 9, "", locked_ns / 1e6, par_ns / 1e6, batch_ns / 1e6);
+
+        freecs_destroy_event_queue(&queue);
+        freecs_destroy_thread_pool(pool);
+    }
+
+    pthread_mutex_destroy(&lock);
+    freecs_destroy_world(&world);
+}
+
+static void bench_events(void) {
+    freecs_event_queue_t copies[EVENT_CONSUMERS];
+    for (size_t c = 0; c < EVENT_CONSUMERS; c++) {
+        copies[c] = FREECS_CREATE_EVENT_QUEUE(BenchDiedEvent);
+    }
+    freecs_event_queue_t shared = FREECS_CREATE_EVENT_QUEUE(BenchDiedEvent);
+    freecs_event_reader_t readers[EVENT_CONSUMERS];
+    for (size_t c = 0; c < EVENT_CONSUMERS; c++) {
+        readers[c] = freecs_event_reader(&shared);
+    }
+
+    uint64_t copy_total = 0;
+    double start = now_ns();
+    for (size_t frame = 0; frame < EVENT_FRAMES; frame++) {
+        for (uint32_t i = 0; i < EVENT_PER_FRAME; i++) {
+            BenchDiedEvent event = {{i, 0}, (float)i, 0.0f, i & 7, 0};
+            for (size_t c = 0; c < EVENT_CONSUMERS; c++) {
+                freecs_send_event(&copies[c], &event);
+            }
+        }
+        for (size_t c = 0; c < EVENT_CONSUMERS; c++) {
+            size_t count;
+            BenchDiedEvent* events = FREECS_READ_EVENTS(&copies[c], BenchDiedEvent, &count);
+            copy_total += consume_died_events(events, count);
+            freecs_clear_events(&copies[c]);
+        }
+    }
+    double copy_ns = (now_ns() - start) / EVENT_FRAMES;
+
+    uint64_t reader_total = 0;
+    start = now_ns();
+    for (size_t frame = 0; frame < EVENT_FRAMES; frame++) {
+        for (uint32_t i = 0; i < EVENT_PER_FRAME; i++) {
+            BenchDiedEvent event = {{i, 0}, (float)i, 0.0f, i & 7, 0};
+            freecs_send_event(&shared, &event);
+        }
+        for (size_t c = 0; c < EVENT_CONSUMERS; c++) {
+            size_t count;
+            BenchDiedEvent* events;
+            while ((events = FREECS_READ_NEW_EVENTS(&shared, &readers[c], BenchDiedEvent, &count)) != NULL) {
+                reader_total += consume_died_events(events, count);
+            }
+        }
+        freecs_update_events(&shared);
+    }
+    double reader_ns = (now_ns() - start) / EVENT_FRAMES;
+
+    printf("  queue per consumer   | %8.1f us/frame\n", copy_ns / 1000.0);
+    printf("  shared + readers     | %8.1f us/frame\n", reader_ns / 1000.0);
+    if (copy_total != reader_total) printf("unexpected\n");
+    bench_sink = (size_t)reader_total;
+
+    for (size_t c = 0; c < EVENT_CONSUMERS; c++) {
+        freecs_destroy_event_queue(&copies[c]);
+    }
+    freecs_destroy_event_queue(&shared);
+}
+
+typedef struct {
+    float x;
+    float y;
+    float vx;
+    float vy;
+} BoidSample;
+
+typedef struct {
+    BoidSample* samples;
+    BoidSample* sorted;
+    uint32_t* cell_starts;
+    size_t capacity;
+    int width;
+    int height;
+} BoidGrid;
+
+static void boids_setup(BenchState* state) {
+    BoidGrid* grid = calloc(1, sizeof(BoidGrid));
+    grid->width = (int)ceilf(BOIDS_WIDTH / BOIDS_CELL);
+    grid->height = (int)ceilf(BOIDS_HEIGHT / BOIDS_CELL);
+    grid->capacity = BOIDS_COUNT;
+    grid->samples = malloc(BOIDS_COUNT * sizeof(BoidSample));
+    grid->sorted = malloc(BOIDS_COUNT * sizeof(BoidSample));
+    grid->cell_starts = malloc(((size_t)grid->width * grid->height + 1) * sizeof(uint32_t));
+    state->scenario = grid;
+
+    Vec2* positions = malloc(BOIDS_COUNT * sizeof(Vec2));
+    Vec2* velocities = malloc(BOIDS_COUNT * sizeof(Vec2));
+    for (size_t i = 0; i < BOIDS_COUNT; i++) {
+        float angle = (float)(rng_next() % 6283) / 1000.0f;
+        float speed = 100.0f + (float)(rng_next() % 100);
+        positions[i] = (Vec2){(float)(rng_next() % (uint64_t)BOIDS_WIDTH), (float)(rng_next() % (uint64_t)BOIDS_HEIGHT)};
+        velocities[i] = (Vec2){cosf(angle) * speed, sinf(angle) * speed};
+    }
+    const void* sources[3] = {positions, velocities, NULL};
+    state->entities = freecs_spawn_batch_columns(&state->world, freecs_mask_or(freecs_mask_or(state->position, state->velocity), state->health), BOIDS_COUNT, sources, &state->count);
+    free(positions);
+    free(velocities);
+}
+
+static int boid_cell(const BoidGrid* grid, float x, float y) {
+    int cell_x = (int)(x / BOIDS_CELL);
+    int cell_y = (int)(y / BOIDS_CELL);
+    if (cell_x < 0) cell_x = 0;
+    if (cell_x >= grid->width) cell_x = grid->width - 1;
+    if (cell_y < 0) cell_y = 0;
+    if (cell_y >= grid->height) cell_y = grid->height - 1;
+    return cell_x + cell_y * grid->width;
+}
+
+static void boids_tick(BenchState* state, BoidGrid* grid) {
+    freecs_mask_t mask = freecs_mask_or(state->position, state->velocity);
+    size_t cells = (size_t)grid->width * grid->height;
+    memset(grid->cell_starts, 0, (cells + 1) * sizeof(uint32_t));
+
+    size_t count = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(&state->world, mask, FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&result, Vec2, state->position);
+        Vec2* velocities = FREECS_ITER_COLUMN(&result, Vec2, state->velocity);
+        for (size_t i = 0; i < result.row_count; i++) {
+            grid->samples[count] = (BoidSample){positions[i].x, positions[i].y, velocities[i].x, velocities[i].y};
+            grid->cell_starts[boid_cell(grid, positions[i].x, positions[i].y) + 1]++;
+            count++;
+        }
+    }
+    for (size_t c = 0; c < cells; c++) {
+        grid->cell_starts[c + 1] += grid->cell_starts[c];
+    }
+    for (size_t i = 0; i < count; i++) {
+        int cell = boid_cell(grid, grid->samples[i].x, grid->samples[i].y);
+        grid->sorted[grid->cell_starts[cell]++] = grid->samples[i];
+    }
+    for (size_t c = cells; c > 0; c--) {
+        grid->cell_starts[c] = grid->cell_starts[c - 1];
+    }
+    grid->cell_starts[0] = 0;
+
+    float range_sq = BOIDS_RANGE * BOIDS_RANGE;
+    iter = freecs_table_iterator(&state->world, mask, FREECS_MASK_EMPTY);
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&result, Vec2, state->position);
+        Vec2* velocities = FREECS_ITER_COLUMN(&result, Vec2, state->velocity);
+        for (size_t i = 0; i < result.row_count; i++) {
+            Vec2 pos = positions[i];
+            Vec2 vel = velocities[i];
+            float align_x = 0.0f, align_y = 0.0f;
+            float cohesion_x = 0.0f, cohesion_y = 0.0f;
+            float sep_x = 0.0f, sep_y = 0.0f;
+            int neighbors = 0;
+
+            int cell_x = (int)(pos.x / BOIDS_CELL);
+            int cell_y = (int)(pos.y / BOIDS_CELL);
+            for (int dy = -1; dy <= 1 && neighbors < BOIDS_MAX_NEIGHBORS; dy++) {
+                int cy = cell_y + dy;
+                if (cy < 0 || cy >= grid->height) continue;
+                for (int dx = -1; dx <= 1 && neighbors < BOIDS_MAX_NEIGHBORS; dx++) {
+                    int cx = cell_x + dx;
+                    if (cx < 0 || cx >= grid->width) continue;
+                    int cell = cx + cy * grid->width;
+                    for (uint32_t j = grid->cell_starts[cell]; j < grid->cell_starts[cell + 1] && neighbors < BOIDS_MAX_NEIGHBORS; j++) {
+                        BoidSample other = grid->sorted[j];
+                        float bx = other.x - pos.x;
+                        float by = other.y - pos.y;
+                        float dist_sq = bx * bx + by * by;
+                        if (dist_sq > 0.0f && dist_sq < range_sq) {
+                            align_x += other.vx;
+                            align_y += other.vy;
+                            cohesion_x += other.x;
+                            cohesion_y += other.y;
+                            float inv_dist = 1.0f / sqrtf(dist_sq);
+                            sep_x -= bx * inv_dist;
+                            sep_y -= by * inv_dist;
+                            neighbors++;
+                        }
+                    }
+                }
+            }
+
+            if (neighbors > 0) {
+                float inv = 1.0f / (float)neighbors;
+                vel.x += align_x * inv * 0.5f + (cohesion_x * inv - pos.x) * 0.3f + sep_x * 0.4f;
+                vel.y += align_y * inv * 0.5f + (cohesion_y * inv - pos.y) * 0.3f + sep_y * 0.4f;
+            }
+            float speed = sqrtf(vel.x * vel.x + vel.y * vel.y);
+            if (speed > 300.0f) {
+                vel.x *= 300.0f / speed;
+                vel.y *= 300.0f / speed;
+            } else if (speed < 100.0f && speed > 0.0f) {
+                vel.x *= 100.0f / speed;
+                vel.y *= 100.0f / speed;
+            }
+            velocities[i] = vel;
+
+            pos.x += vel.x * BENCH_DT;
+            pos.y += vel.y * BENCH_DT;
+            if (pos.x < 0.0f) pos.x += BOIDS_WIDTH;
+            else if (pos.x > BOIDS_WIDTH) pos.x -= BOIDS_WIDTH;
+            if (pos.y < 0.0f) pos.y += BOIDS_HEIGHT;
+            else if (pos.y > BOIDS_HEIGHT) pos.y -= BOIDS_HEIGHT;
+            positions[i] = pos;
+        }
+    }
+}
+
+static size_t boids_run(BenchState* state) {
+    BoidGrid* grid = state->scenario;
+    for (int tick = 0; tick < BOIDS_TICKS; tick++) {
+        boids_tick(state, grid);
+    }
+    return (size_t)BOIDS_TICKS * state->count;
+}
+
+static void boids_teardown(BenchState* state) {
+    BoidGrid* grid = state->scenario;
+    free(grid->samples);
+    free(grid->sorted);
+    free(grid->cell_starts);
+    free(grid);
+}
+
+typedef struct {
+    float health;
+    float speed;
+    uint32_t path_index;
+    float path_progress;
+} TdEnemy;
+
+typedef struct {
+    float range;
+    float cooldown;
+    float fire_rate;
+    float damage;
+} TdTower;
+
+typedef struct {
+    freecs_entity_t target;
+    float damage;
+    float speed;
+} TdProjectile;
+
+typedef struct {
+    freecs_mask_t enemy;
+    freecs_mask_t tower;
+    freecs_mask_t projectile;
+    freecs_mask_t effect;
+    Vec2 path[TD_PATH_POINTS];
+    freecs_command_buffer_t commands;
+    freecs_entity_t* targets;
+    Vec2* target_positions;
+    size_t targets_cap;
+} TdScenario;
+
+static void td_setup(BenchState* state) {
+    TdScenario* td = calloc(1, sizeof(TdScenario));
+    td->enemy = FREECS_REGISTER(&state->world, TdEnemy);
+    td->tower = FREECS_REGISTER(&state->world, TdTower);
+    td->projectile = FREECS_REGISTER(&state->world, TdProjectile);
+    td->effect = freecs_register_component(&state->world, sizeof(float));
+    td->commands = freecs_create_command_buffer(&state->world);
+    for (size_t i = 0; i < TD_PATH_POINTS; i++) {
+        td->path[i] = (Vec2){(float)(i * 100), (i % 2 == 0) ? 100.0f : 600.0f};
+    }
+    state->scenario = td;
+
+    for (size_t i = 0; i < TD_TOWERS; i++) {
+        Vec2 position = {(float)(i % 16) * 60.0f + 30.0f, (float)(i / 16) * 150.0f + 75.0f};
+        TdTower tower = {120.0f, 0.0f, 0.25f, 4.0f};
+        freecs_type_info_entry_t entries[2] = {
+            {state->position, sizeof(Vec2), &position, freecs_bit_index(state->position)},
+            {td->tower, sizeof(TdTower), &tower, freecs_bit_index(td->tower)}
+        };
+        freecs_spawn(&state->world, freecs_mask_or(state->position, td->tower), entries, 2);
+    }
+}
+
+static size_t td_tick(BenchState* state, TdScenario* td) {
+    freecs_world_t* world = &state->world;
+
+    for (size_t i = 0; i < TD_SPAWNS_PER_TICK; i++) {
+        Vec2 position = td->path[0];
+        Vec2 velocity = {0.0f, 0.0f};
+        TdEnemy enemy = {20.0f, 60.0f + (float)(rng_next() % 60), 0, 0.0f};
+        freecs_type_info_entry_t entries[3] = {
+            {state->position, sizeof(Vec2), &position, freecs_bit_index(state->position)},
+            {state->velocity, sizeof(Vec2), &velocity, freecs_bit_index(state->velocity)},
+            {td->enemy, sizeof(TdEnemy), &enemy, freecs_bit_index(td->enemy)}
+        };
+        freecs_queue_spawn(&td->commands, freecs_mask_or(freecs_mask_or(state->position, state->velocity), td->enemy), entries, 3);
+    }
+
+    size_t enemy_count = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(world, freecs_mask_or(state->position, td->enemy), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&result, Vec2, state->position);
+        TdEnemy* enemies = FREECS_ITER_COLUMN(&result, TdEnemy, td->enemy);
+        freecs_entity_t* entities = &result.archetype->entities[result.row_start];
+        for (size_t i = 0; i < result.row_count; i++) {
+            TdEnemy* enemy = &enemies[i];
+            enemy->path_progress += enemy->speed * BENCH_DT;
+            Vec2 from = td->path[enemy->path_index];
+            Vec2 to = td->path[enemy->path_index + 1];
+            float dx = to.x - from.x;
+            float dy = to.y - from.y;
+            float length = sqrtf(dx * dx + dy * dy);
+            if (enemy->path_progress >= length) {
+                enemy->path_progress -= length;
+                enemy->path_index++;
+                if (enemy->path_index >= TD_PATH_POINTS - 1) {
+                    freecs_queue_despawn(world, entities[i]);
+                    continue;
+                }
+                from = td->path[enemy->path_index];
+                to = td->path[enemy->path_index + 1];
+                dx = to.x - from.x;
+                dy = to.y - from.y;
+                length = sqrtf(dx * dx + dy * dy);
+            }
+            positions[i].x = from.x + dx / length * enemy->path_progress;
+            positions[i].y = from.y + dy / length * enemy->path_progress;
+
+            if (enemy_count == td->targets_cap) {
+                td->targets_cap = td->targets_cap == 0 ? 1024 : td->targets_cap * 2;
+                td->targets = realloc(td->targets, td->targets_cap * sizeof(freecs_entity_t));
+                td->target_positions = realloc(td->target_positions, td->targets_cap * sizeof(Vec2));
+            }
+            td->targets[enemy_count] = entities[i];
+            td->target_positions[enemy_count] = positions[i];
+            enemy_count++;
+        }
+    }
+
+    iter = freecs_table_iterator(world, freecs_mask_or(state->position, td->tower), FREECS_MASK_EMPTY);
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&result, Vec2, state->position);
+        TdTower* towers = FREECS_ITER_COLUMN(&result, TdTower, td->tower);
+        for (size_t i = 0; i < result.row_count; i++) {
+            TdTower* tower = &towers[i];
+            tower->cooldown -= BENCH_DT;
+            if (tower->cooldown > 0.0f) continue;
+
+            float best_sq = tower->range * tower->range;
+            size_t best = (size_t)-1;
+            for (size_t k = 0; k < enemy_count; k++) {
+                float dx = td->target_positions[k].x - positions[i].x;
+                float dy = td->target_positions[k].y - positions[i].y;
+                float dist_sq = dx * dx + dy * dy;
+                if (dist_sq < best_sq) {
+                    best_sq = dist_sq;
+                    best = k;
+                }
+            }
+            if (best == (size_t)-1) continue;
+
+            tower->cooldown = tower->fire_rate;
+            Vec2 position = positions[i];
+            TdProjectile projectile = {td->targets[best], tower->damage, 400.0f};
+            freecs_type_info_entry_t entries[2] = {
+                {state->position, sizeof(Vec2), &position, freecs_bit_index(state->position)},
+                {td->projectile, sizeof(TdProjectile), &projectile, freecs_bit_index(td->projectile)}
+            };
+            freecs_queue_spawn(&td->commands, freecs_mask_or(state->position, td->projectile), entries, 2);
+        }
+    }
+
+    size_t projectile_count = 0;
+    iter = freecs_table_iterator(world, freecs_mask_or(state->position, td->projectile), FREECS_MASK_EMPTY);
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Vec2* positions = FREECS_ITER_COLUMN(&result, Vec2, state->position);
+        TdProjectile* projectiles = FREECS_ITER_COLUMN(&result, TdProjectile, td->projectile);
+        freecs_entity_t* entities = &result.archetype->entities[result.row_start];
+        for (size_t i = 0; i < result.row_count; i++) {
+            projectile_count++;
+            Vec2* target = freecs_get(world, projectiles[i].target, state->position);
+            if (target == NULL) {
+                freecs_queue_despawn(world, entities[i]);
+                continue;
+            }
+            float dx = target->x - positions[i].x;
+            float dy = target->y - positions[i].y;
+            float distance = sqrtf(dx * dx + dy * dy);
+            if (distance < 10.0f) {
+                TdEnemy* enemy = freecs_get(world, projectiles[i].target, td->enemy);
+                if (enemy->health > 0.0f) {
+                    enemy->health -= projectiles[i].damage;
+                    if (enemy->health <= 0.0f) {
+                        freecs_queue_despawn(world, projectiles[i].target);
+                        float lifetime = 0.5f;
+                        freecs_type_info_entry_t entries[2] = {
+                            {state->position, sizeof(Vec2), target, freecs_bit_index(state->position)},
+                            {td->effect, sizeof(float), &lifetime, freecs_bit_index(td->effect)}
+                        };
+                        freecs_queue_spawn(&td->commands, freecs_mask_or(state->position, td->effect), entries, 2);
+                    }
+                }
+                freecs_queue_despawn(world, entities[i]);
+            } else {
+                float step = projectiles[i].speed * BENCH_DT / distance;
+                positions[i].x += dx * step;
+                positions[i].y += dy * step;
+            }
+        }
+    }
+
+    size_t effect_count = 0;
+    iter = freecs_table_iterator(world, td->effect, FREECS_MASK_EMPTY);
+    while (freecs_table_iterator_next(&iter, &result)) {
+        float* lifetimes = FREECS_ITER_COLUMN(&result, float, td->effect);
+        freecs_entity_t* entities = &result.archetype->entities[result.row_start];
+        for (size_t i = 0; i < result.row_count; i++) {
+            effect_count++;
+            lifetimes[i] -= BENCH_DT;
+            if (lifetimes[i] <= 0.0f) {
+                freecs_queue_despawn(world, entities[i]);
+            }
+        }
+    }
+
+    freecs_apply_despawns(world);
+    freecs_apply_commands(&td->commands);
+    return enemy_count + projectile_count + effect_count + TD_TOWERS;
+}
+
+static size_t td_run(BenchState* state) {
+    TdScenario* td = state->scenario;
+    size_t processed = 0;
+    for (int tick = 0; tick < TD_TICKS; tick++) {
+        processed += td_tick(state, td);
+    }
+    return processed;
+}
+
+static void td_teardown(BenchState* state) {
+    TdScenario* td = state->scenario;
+    freecs_destroy_command_buffer(&td->commands);
+    free(td->targets);
+    free(td->target_positions);
+    free(td);
+}
+
+static void bench_scenarios(void) {
+    BenchCase cases[] = {
+        {"boids (per tick)", BOIDS_TICKS, boids_setup, boids_run, boids_teardown},
+        {"tower defense (per tick)", TD_TICKS, td_setup, td_run, td_teardown}
+    };
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        run_case(&cases[i]);
+    }
+}
+
+static bool section_enabled(int argc, char** argv, const char* name) {
+    if (argc < 2) return true;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], name) == 0) return true;
+    }
+    return false;
+}
+
+int main(int argc, char** argv) {
+    if (section_enabled(argc, argv, "core")) {
+        printf("Core operations (%d entities, %d warmup + %d runs)\n", CORE_ENTITIES, BENCH_WARMUP, BENCH_REPETITIONS);
+        bench_core();
+    }
+
+    if (section_enabled(argc, argv, "scenarios")) {
+        printf("\nScenarios (%d boids x %d ticks, tower defense %d ticks)\n", BOIDS_COUNT, BOIDS_TICKS, TD_TICKS);
+        bench_scenarios();
+    }
+
+    if (section_enabled(argc, argv, "lookup")) {
+        printf("\nArchetype lookup\n");
+        size_t sizes[] = {10, 100, 1000, 10000, 100000};
+        for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+            bench_archetype_lookup(sizes[i]);
+        }
+    }
+
+    if (section_enabled(argc, argv, "parallel")) {
+        printf("\nParallel table iteration (%d entities, 3 archetypes)\n", PAR_ENTITIES);
+        bench_parallel();
+    }
+
+    if (section_enabled(argc, argv, "commands")) {
+        printf("\nComponent flips (%d entities per tick)\n", FLIP_ENTITIES);
+        bench_command_flips();
+
+        printf("\nCommand buffer spawn waves (%d spawns per tick)\n", WAVE_SPAWNS);
+        bench_command_spawns();
+    }
+
+    if (section_enabled(argc, argv, "despawn")) {
+        printf("\nWave clears (%d entities per tick, 2 archetypes)\n", CLEAR_ENTITIES);
+        bench_wave_clear();
+    }
+
+    if (section_enabled(argc, argv, "ingest")) {
+        printf("\nBulk ingest (%d entities)\n", INGEST_ENTITIES);
+        bench_ingest();
+    }
+
+    if (section_enabled(argc, argv, "random")) {
+        printf("\nRandom lookups (%d entities)\n", LOOKUP_ENTITIES);
+        bench_random_get();
+    }
+
+    if (section_enabled(argc, argv, "spatial")) {
+        printf("\nSpatial index (%d entities, cell %.0f)\n", SPATIAL_ENTITIES, SPATIAL_CELL);
+        bench_spatial();
+    }
+
+    if (section_enabled(argc, argv, "changes")) {
+        printf("\nChange detection (%d entities)\n", CHANGE_ENTITIES);
+        bench_changes();
+    }
+
+    if (section_enabled(argc, argv, "tags")) {
+        printf("\nTags (%d tagged entities)\n", TAG_ENTITIES);
+        bench_tags();
+        bench_tag_queries();
+    }
+
+    if (section_enabled(argc, argv, "events")) {
+        printf("\nEvents (%d per frame, %d consumers)\n", EVENT_PER_FRAME, EVENT_CONSUMERS);
+        bench_events();
+        bench_event_producers();
+    }
+    return 0;
+}
@@ -44,9 +44,9 @@ typedef struct {
     float value;
 } Health;
 
-static uint64_t BIT_POSITION;
-static uint64_t BIT_VELOCITY;
-static uint64_t BIT_HEALTH;
+static freecs_mask_t BIT_POSITION;
+static freecs_mask_t BIT_VELOCITY;
+static freecs_mask_t BIT_HEALTH;
 
 static void setup_world(freecs_world_t* world) {
     BIT_POSITION = FREECS_REGISTER(world, Position);
@@ -65,7 +65,7 @@ TEST(spawn_entity) {
         {BIT_VELOCITY, sizeof(Velocity), &vel, freecs_bit_index(BIT_VELOCITY)}
     };
 
-    freecs_entity_t entity = freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY, entries, 2);
+    freecs_entity_t entity = freecs_spawn(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), entries, 2);
 
     ASSERT_EQ(entity.id, 0);
     ASSERT_EQ(entity.generation, 0);
@@ -85,7 +85,7 @@ TEST(get_component) {
         {BIT_VELOCITY, sizeof(Velocity), &vel, freecs_bit_index(BIT_VELOCITY)}
     };
 
-    freecs_entity_t entity = freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY, entries, 2);
+    freecs_entity_t entity = freecs_spawn(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), entries, 2);
 
     Position* got_pos = FREECS_GET(&world, entity, Position, BIT_POSITION);
     ASSERT(got_pos != NULL);
@@ -180,6 +180,57 @@ TEST(generational_indices) {
     freecs_destroy_world(&world);
 }
 
+TEST(dead_slots_reject_next_generation) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    ASSERT_EQ(sizeof(freecs_entity_location_t), 12);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 2, &count);
+    freecs_entity_t next = {entities[0].id, entities[0].generation + 1};
+    freecs_despawn(&world, entities[0]);
+
+    ASSERT(!freecs_is_alive(&world, entities[0]));
+    ASSERT(!freecs_is_alive(&world, next));
+    ASSERT(freecs_get(&world, next, BIT_POSITION) == NULL);
+    ASSERT(!freecs_despawn(&world, next));
+    ASSERT(!freecs_add_component(&world, next, BIT_HEALTH, &(Health){1.0f}, sizeof(Health)));
+
+    freecs_entity_t forged = {entities[0].id, world.locations[entities[0].id].generation};
+    ASSERT(forged.generation & FREECS_GENERATION_DEAD);
+    ASSERT(!freecs_is_alive(&world, forged));
+    ASSERT(freecs_get(&world, forged, BIT_POSITION) == NULL);
+    ASSERT(!freecs_despawn(&world, forged));
+    ASSERT_EQ(freecs_despawn_batch(&world, &forged, 1), 0);
+    ASSERT_EQ(freecs_entity_count(&world), 1);
+    ASSERT(freecs_is_alive(&world, entities[1]));
+
+    freecs_entity_location_t saved = world.locations[entities[0].id];
+    world.locations[entities[0].id] = (freecs_entity_location_t){0, 0, FREECS_GENERATION_DEAD};
+    freecs_entity_t unused = {entities[0].id, FREECS_GENERATION_DEAD};
+    ASSERT(!freecs_is_alive(&world, unused));
+    ASSERT(!freecs_is_alive(&world, (freecs_entity_t){entities[0].id, 0}));
+    ASSERT(!freecs_despawn(&world, unused));
+    ASSERT(!freecs_add_component(&world, unused, BIT_HEALTH, &(Health){1.0f}, sizeof(Health)));
+    ASSERT_EQ(freecs_entity_count(&world), 1);
+    world.locations[entities[0].id] = saved;
+
+    world.locations[entities[1].id].generation = FREECS_GENERATION_DEAD - 1;
+    freecs_entity_t last = {entities[1].id, FREECS_GENERATION_DEAD - 1};
+    ASSERT(freecs_despawn(&world, last));
+    free(entities);
+
+    entities = freecs_spawn_batch(&world, BIT_POSITION, 2, &count);
+    ASSERT_EQ(entities[0].generation, 1);
+    ASSERT_EQ(entities[1].generation, 0);
+    ASSERT(freecs_is_alive(&world, entities[1]));
+    ASSERT(!freecs_is_alive(&world, last));
+
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
 TEST(multiple_archetypes) {
     freecs_world_t world = freecs_create_world();
     setup_world(&world);
@@ -204,8 +255,8 @@ TEST(multiple_archetypes) {
     };
 
     freecs_entity_t ent1 = freecs_spawn(&world, BIT_POSITION, e1, 1);
-    freecs_entity_t ent2 = freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY, e2, 2);
-    freecs_entity_t ent3 = freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY | BIT_HEALTH, e3, 3);
+    freecs_entity_t ent2 = freecs_spawn(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), e2, 2);
+    freecs_entity_t ent3 = freecs_spawn(&world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_HEALTH), e3, 3);
 
     ASSERT_EQ(world.archetypes_len, 3);
 
@@ -241,7 +292,7 @@ TEST(query_count) {
         {BIT_POSITION, sizeof(Position), &pos3, freecs_bit_index(BIT_POSITION)},
         {BIT_VELOCITY, sizeof(Velocity), &vel3, freecs_bit_index(BIT_VELOCITY)}
     };
-    freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY, e3, 2);
+    freecs_spawn(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), e3, 2);
 
     Position pos4 = {4, 4};
     Velocity vel4 = {0, 1};
@@ -251,12 +302,12 @@ TEST(query_count) {
         {BIT_VELOCITY, sizeof(Velocity), &vel4, freecs_bit_index(BIT_VELOCITY)},
         {BIT_HEALTH, sizeof(Health), &health4, freecs_bit_index(BIT_HEALTH)}
     };
-    freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY | BIT_HEALTH, e4, 3);
+    freecs_spawn(&world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_HEALTH), e4, 3);
 
-    ASSERT_EQ(freecs_query_count(&world, BIT_POSITION, 0), 4);
-    ASSERT_EQ(freecs_query_count(&world, BIT_VELOCITY, 0), 2);
-    ASSERT_EQ(freecs_query_count(&world, BIT_HEALTH, 0), 1);
-    ASSERT_EQ(freecs_query_count(&world, BIT_POSITION | BIT_VELOCITY, 0), 2);
+    ASSERT_EQ(freecs_query_count(&world, BIT_POSITION, FREECS_MASK_EMPTY), 4);
+    ASSERT_EQ(freecs_query_count(&world, BIT_VELOCITY, FREECS_MASK_EMPTY), 2);
+    ASSERT_EQ(freecs_query_count(&world, BIT_HEALTH, FREECS_MASK_EMPTY), 1);
+    ASSERT_EQ(freecs_query_count(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), FREECS_MASK_EMPTY), 2);
 
     freecs_destroy_world(&world);
 }
@@ -298,7 +349,7 @@ TEST(remove_component) {
         {BIT_POSITION, sizeof(Position), &pos, freecs_bit_index(BIT_POSITION)},
         {BIT_VELOCITY, sizeof(Velocity), &vel, freecs_bit_index(BIT_VELOCITY)}
     };
-    freecs_entity_t entity = freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY, e, 2);
+    freecs_entity_t entity = freecs_spawn(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), e, 2);
 
     ASSERT(freecs_has(&world, entity, BIT_VELOCITY));
 
@@ -320,7 +371,7 @@ TEST(spawn_batch) {
     setup_world(&world);
 
     size_t count;
-    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION | BIT_VELOCITY, 5, &count);
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), 5, &count);
 
     ASSERT_EQ(count, 5);
     ASSERT_EQ(freecs_entity_count(&world), 5);
@@ -334,6 +385,86 @@ TEST(spawn_batch) {
     freecs_destroy_world(&world);
 }
 
+TEST(spawn_batch_columns) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t count;
+    freecs_entity_t* existing = freecs_spawn_batch(&world, BIT_POSITION, 10, &count);
+    freecs_despawn_batch(&world, existing, 4);
+
+    size_t total = 40000;
+    Position* positions = malloc(total * sizeof(Position));
+    Health* healths = malloc(total * sizeof(Health));
+    for (size_t i = 0; i < total; i++) {
+        positions[i] = (Position){(float)i, -(float)i};
+        healths[i] = (Health){(float)(i % 100)};
+    }
+
+    const void* sources[3] = {positions, NULL, healths};
+    freecs_entity_t* entities = freecs_spawn_batch_columns(&world, freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_HEALTH), total, sources, &count);
+    ASSERT_EQ(count, total);
+    ASSERT_EQ(freecs_entity_count(&world), total + 6);
+    ASSERT_EQ(world.free_entities_len, 0);
+    ASSERT_EQ(world.next_entity_id, total + 6);
+
+    for (size_t i = 0; i < total; i++) {
+        ASSERT(freecs_is_alive(&world, entities[i]));
+        Position* pos = FREECS_GET(&world, entities[i], Position, BIT_POSITION);
+        ASSERT_FLOAT_EQ(pos->x, (float)i);
+        ASSERT_FLOAT_EQ(pos->y, -(float)i);
+        ASSERT_FLOAT_EQ(FREECS_GET(&world, entities[i], Velocity, BIT_VELOCITY)->x, 0.0f);
+        ASSERT_FLOAT_EQ(FREECS_GET(&world, entities[i], Health, BIT_HEALTH)->value, (float)(i % 100));
+    }
+    ASSERT_EQ(entities[0].generation, 1);
+    ASSERT_EQ(entities[4].generation, 0);
+
+    ASSERT(freecs_spawn_batch_columns(&world, FREECS_MASK_EMPTY, 10, sources, &count) == NULL);
+    ASSERT_EQ(count, 0);
+
+    free(positions);
+    free(healths);
+    free(entities);
+    free(existing);
+    freecs_destroy_world(&world);
+}
+
+TEST(entity_range_allocation) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 1000, &count);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(entities[i].id, i);
+    }
+
+    freecs_entity_t victims[500];
+    for (size_t i = 0; i < 500; i++) {
+        victims[i] = entities[(i * 7) % 500 * 2 + 1];
+    }
+    freecs_despawn_batch(&world, victims, 500);
+    ASSERT(freecs_despawn(&world, entities[0]));
+    free(entities);
+
+    entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), 501, &count);
+    for (size_t i = 1; i < count; i++) {
+        ASSERT(entities[i].id > entities[i - 1].id);
+        ASSERT_EQ(entities[i].generation, 1);
+    }
+    ASSERT_EQ(world.free_entities_len, 0);
+    ASSERT_EQ(world.next_entity_id, 1000);
+    free(entities);
+
+    entities = freecs_spawn_batch(&world, BIT_POSITION, 3, &count);
+    ASSERT_EQ(entities[0].id, 1000);
+    ASSERT_EQ(entities[2].id, 1002);
+    ASSERT_EQ(world.locations_len, 1003);
+    free(entities);
+
+    freecs_destroy_world(&world);
+}
+
 TEST(event_queue) {
     typedef struct {
         uint32_t entity_id;
@@ -363,6 +494,138 @@ TEST(event_queue) {
     freecs_destroy_event_queue(&queue);
 }
 
+static size_t drain_events(freecs_event_queue_t* queue, freecs_event_reader_t* reader, uint32_t* out) {
+    size_t total = 0;
+    size_t count;
+    uint32_t* events;
+    while ((events = FREECS_READ_NEW_EVENTS(queue, reader, uint32_t, &count)) != NULL) {
+        memcpy(&out[total], events, count * sizeof(uint32_t));
+        total += count;
+    }
+    return total;
+}
+
+TEST(event_readers) {
+    freecs_event_queue_t queue = FREECS_CREATE_EVENT_QUEUE(uint32_t);
+    freecs_event_reader_t rewards = freecs_event_reader(&queue);
+    freecs_event_reader_t effects = freecs_event_reader(&queue);
+    uint32_t seen[16];
+
+    for (uint32_t i = 1; i <= 2; i++) FREECS_SEND_EVENT(&queue, uint32_t, i);
+    ASSERT_EQ(drain_events(&queue, &rewards, seen), 2);
+    ASSERT_EQ(seen[1], 2);
+    ASSERT_EQ(drain_events(&queue, &rewards, seen), 0);
+
+    uint8_t* first_buffer = queue.data;
+    freecs_update_events(&queue);
+    FREECS_SEND_EVENT(&queue, uint32_t, 3u);
+    ASSERT_EQ(freecs_event_count(&queue), 1);
+    ASSERT_EQ(freecs_unread_event_count(&queue, &effects), 3);
+    ASSERT_EQ(drain_events(&queue, &rewards, seen), 1);
+    ASSERT_EQ(seen[0], 3);
+    ASSERT_EQ(drain_events(&queue, &effects, seen), 3);
+    ASSERT_EQ(seen[0], 1);
+    ASSERT_EQ(seen[2], 3);
+
+    freecs_event_reader_t late = freecs_event_reader(&queue);
+    freecs_update_events(&queue);
+    FREECS_SEND_EVENT(&queue, uint32_t, 4u);
+    ASSERT_EQ(queue.data, first_buffer);
+    ASSERT_EQ(drain_events(&queue, &late, seen), 2);
+    ASSERT_EQ(seen[0], 3);
+    ASSERT_EQ(seen[1], 4);
+
+    freecs_update_events(&queue);
+    freecs_update_events(&queue);
+    ASSERT_EQ(freecs_unread_event_count(&queue, &rewards), 0);
+    ASSERT_EQ(drain_events(&queue, &rewards, seen), 0);
+
+    FREECS_SEND_EVENT(&queue, uint32_t, 5u);
+    freecs_update_events(&queue);
+    FREECS_SEND_EVENT(&queue, uint32_t, 6u);
+    freecs_clear_events(&queue);
+    FREECS_SEND_EVENT(&queue, uint32_t, 7u);
+    ASSERT_EQ(drain_events(&queue, &effects, seen), 1);
+    ASSERT_EQ(seen[0], 7);
+
+    freecs_destroy_event_queue(&queue);
+}
+
+static void par_send_row(freecs_archetype_t* arch, size_t row, size_t thread_index, void* user) {
+    (void)thread_index;
+    freecs_event_queue_t* queue = user;
+    FREECS_PAR_SEND_EVENT(queue, uint32_t, arch->entities[row].id);
+}
+
+static void par_send_table(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    (void)thread_index;
+    uint32_t ids[100];
+    for (size_t start = 0; start < view->row_count; start += 100) {
+        size_t count = view->row_count - start < 100 ? view->row_count - start : 100;
+        for (size_t i = 0; i < count; i++) {
+            ids[i] = view->archetype->entities[view->row_start + start + i].id;
+        }
+        freecs_par_send_events(user, ids, count);
+    }
+}
+
+TEST(par_send_events) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 50000, &count);
+    freecs_thread_pool_t* pool = freecs_create_thread_pool(4);
+    freecs_event_queue_t queue = FREECS_CREATE_EVENT_QUEUE(uint32_t);
+    freecs_event_reader_t reader = freecs_event_reader(&queue);
+    uint8_t* seen = calloc(world.locations_len, 1);
+
+    for (int frame = 0; frame < 2; frame++) {
+        FREECS_SEND_EVENT(&queue, uint32_t, 0xFFFFFFFFu);
+        freecs_par_for_each(pool, &world, BIT_POSITION, FREECS_MASK_EMPTY, par_send_row, &queue);
+        FREECS_SEND_EVENT(&queue, uint32_t, 0xFFFFFFFEu);
+
+        size_t total;
+        uint32_t* events = FREECS_READ_EVENTS(&queue, uint32_t, &total);
+        ASSERT_EQ(total, 50002);
+        ASSERT_EQ(events[0], 0xFFFFFFFFu);
+        ASSERT_EQ(events[total - 1], 0xFFFFFFFEu);
+        memset(seen, 0, world.locations_len);
+        for (size_t i = 1; i + 1 < total; i++) {
+            ASSERT(events[i] < world.locations_len);
+            ASSERT_EQ(seen[events[i]], 0);
+            seen[events[i]] = 1;
+        }
+
+        size_t read = 0;
+        size_t slice;
+        while (freecs_read_new_events(&queue, &reader, &slice) != NULL) {
+            read += slice;
+        }
+        ASSERT_EQ(read, 50002);
+        freecs_update_events(&queue);
+    }
+
+    freecs_par_for_each_table(pool, &world, BIT_POSITION, FREECS_MASK_EMPTY, par_send_table, &queue);
+    size_t total;
+    uint32_t* events = FREECS_READ_EVENTS(&queue, uint32_t, &total);
+    ASSERT_EQ(total, 50000);
+    memset(seen, 0, world.locations_len);
+    for (size_t i = 0; i < total; i++) {
+        ASSERT_EQ(seen[events[i]], 0);
+        seen[events[i]] = 1;
+    }
+
+    freecs_par_send_event(&queue, &(uint32_t){7});
+    freecs_clear_events(&queue);
+    ASSERT_EQ(freecs_event_count(&queue), 0);
+
+    free(seen);
+    freecs_destroy_event_queue(&queue);
+    freecs_destroy_thread_pool(pool);
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
 TEST(tags) {
     freecs_world_t world = freecs_create_world();
     setup_world(&world);
@@ -398,6 +661,178 @@ TEST(tags) {
     freecs_destroy_world(&world);
 }
 
+TEST(tags_sparse_set) {
+    freecs_tags_t tags = freecs_create_tags();
+    int tag_burning = freecs_register_tag(&tags, "burning");
+    int tag_frozen = freecs_register_tag(&tags, "frozen");
+
+    for (uint32_t id = 0; id < 20000; id += 2) {
+        freecs_add_tag(&tags, tag_burning, (freecs_entity_t){id, 1});
+    }
+    freecs_add_tag(&tags, tag_burning, (freecs_entity_t){1000000, 3});
+    freecs_add_tag(&tags, tag_frozen, (freecs_entity_t){4, 1});
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 10001);
+
+    for (uint32_t id = 0; id < 20000; id += 6) {
+        freecs_remove_tag(&tags, tag_burning, (freecs_entity_t){id, 1});
+    }
+    freecs_remove_tag(&tags, tag_burning, (freecs_entity_t){7, 1});
+    freecs_remove_tag(&tags, tag_burning, (freecs_entity_t){500000, 1});
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 10001 - 3334);
+
+    for (uint32_t id = 0; id < 20000; id++) {
+        bool expected = id % 2 == 0 && id % 6 != 0;
+        ASSERT_EQ(freecs_has_tag(&tags, tag_burning, (freecs_entity_t){id, 1}), expected);
+    }
+    ASSERT(freecs_has_tag(&tags, tag_burning, (freecs_entity_t){1000000, 3}));
+    ASSERT(!freecs_has_tag(&tags, tag_burning, (freecs_entity_t){1000000, 2}));
+    ASSERT(!freecs_has_tag(&tags, tag_burning, (freecs_entity_t){2000000, 0}));
+
+    size_t count;
+    const freecs_entity_t* dense = freecs_tag_entities(&tags, tag_burning, &count);
+    ASSERT_EQ(count, freecs_tag_count(&tags, tag_burning));
+    for (size_t i = 0; i < count; i++) {
+        ASSERT(freecs_has_tag(&tags, tag_burning, dense[i]));
+    }
+
+    freecs_add_tag(&tags, tag_burning, (freecs_entity_t){2, 9});
+    ASSERT(!freecs_has_tag(&tags, tag_burning, (freecs_entity_t){2, 1}));
+    ASSERT(freecs_has_tag(&tags, tag_burning, (freecs_entity_t){2, 9}));
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 10001 - 3334);
+
+    freecs_clear_entity_tags(&tags, (freecs_entity_t){4, 1});
+    ASSERT(!freecs_has_tag(&tags, tag_burning, (freecs_entity_t){4, 1}));
+    ASSERT(!freecs_has_tag(&tags, tag_frozen, (freecs_entity_t){4, 1}));
+    ASSERT_EQ(freecs_tag_count(&tags, tag_frozen), 0);
+
+    freecs_destroy_tags(&tags);
+}
+
+TEST(tags_despawn_cleanup) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    freecs_tags_t tags = freecs_create_tags();
+    freecs_attach_tags(&world, &tags);
+    int tag_burning = freecs_register_tag(&tags, "burning");
+    int tag_frozen = freecs_register_tag(&tags, "frozen");
+    int tag_boss = freecs_register_tag(&tags, "boss");
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 100, &count);
+    for (size_t i = 0; i < count; i++) {
+        freecs_add_tag(&tags, tag_burning, entities[i]);
+        if (i % 2 == 0) freecs_add_tag(&tags, tag_frozen, entities[i]);
+    }
+    freecs_add_tag(&tags, tag_boss, entities[7]);
+    ASSERT_EQ(freecs_entity_tags(&tags, entities[7]), FREECS_TAG_BIT(tag_burning) | FREECS_TAG_BIT(tag_boss));
+    ASSERT_EQ(freecs_entity_tags(&tags, entities[8]), FREECS_TAG_BIT(tag_burning) | FREECS_TAG_BIT(tag_frozen));
+
+    freecs_despawn(&world, entities[7]);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_boss), 0);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 99);
+    ASSERT_EQ(freecs_entity_tags(&tags, entities[7]), 0);
+
+    ASSERT_EQ(freecs_despawn_batch(&world, entities, 10), 9);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 90);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_frozen), 45);
+
+    freecs_queue_despawn(&world, entities[10]);
+    freecs_apply_despawns(&world);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 89);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_frozen), 44);
+
+    freecs_entity_t reused = freecs_spawn(&world, BIT_POSITION, NULL, 0);
+    ASSERT(reused.id < 11);
+    ASSERT_EQ(freecs_entity_tags(&tags, reused), 0);
+    ASSERT(!freecs_has_tag(&tags, tag_burning, reused));
+
+    freecs_attach_tags(&world, NULL);
+    freecs_despawn(&world, entities[20]);
+    ASSERT_EQ(freecs_tag_count(&tags, tag_burning), 89);
+
+    free(entities);
+    freecs_destroy_tags(&tags);
+    freecs_destroy_world(&world);
+}
+
+static size_t run_tag_query(freecs_world_t* world, freecs_tags_t* tags, freecs_mask_t mask, freecs_mask_t exclude, uint64_t include_tags, uint64_t exclude_tags, int* driver) {
+    freecs_tag_query_t query = freecs_tag_query(world, tags, mask, exclude, include_tags, exclude_tags);
+    *driver = query.driver;
+    freecs_tag_query_result_t result;
+    size_t count = 0;
+    while (freecs_tag_query_next(&query, &result)) {
+        Position* pos = freecs_column_row(result.archetype, BIT_POSITION, result.row);
+        if (pos == NULL || (uint32_t)pos->x != result.entity.id) return (size_t)-1;
+        if (result.archetype->entities[result.row].id != result.entity.id) return (size_t)-1;
+        count++;
+    }
+
+    query = freecs_tag_query(world, tags, mask, exclude, include_tags, exclude_tags);
+    freecs_tag_query_result_t batch[7];
+    size_t filled = 0;
+    size_t got;
+    while ((got = freecs_tag_query_fill(&query, batch, 7)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            Position* pos = freecs_column_row(batch[i].archetype, BIT_POSITION, batch[i].row);
+            if (pos == NULL || (uint32_t)pos->x != batch[i].entity.id) return (size_t)-1;
+        }
+        filled += got;
+    }
+    return filled == count ? count : (size_t)-1;
+}
+
+TEST(tag_queries) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    freecs_tags_t tags = freecs_create_tags();
+    int tag_burning = freecs_register_tag(&tags, "burning");
+    int tag_frozen = freecs_register_tag(&tags, "frozen");
+
+    size_t count_a, count_b;
+    freecs_entity_t* a = freecs_spawn_batch(&world, BIT_POSITION, 3000, &count_a);
+    freecs_entity_t* b = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), 3000, &count_b);
+    for (size_t i = 0; i < 3000; i++) {
+        FREECS_SET(&world, a[i], Position, BIT_POSITION, ((Position){(float)a[i].id, 0.0f}));
+        FREECS_SET(&world, b[i], Position, BIT_POSITION, ((Position){(float)b[i].id, 0.0f}));
+        if (i % 2 == 0) {
+            freecs_add_tag(&tags, tag_burning, a[i]);
+            freecs_add_tag(&tags, tag_burning, b[i]);
+        }
+        if (i % 100 == 0) {
+            freecs_add_tag(&tags, tag_frozen, a[i]);
+            freecs_add_tag(&tags, tag_frozen, b[i]);
+        }
+    }
+    freecs_despawn(&world, b[0]);
+    freecs_despawn(&world, a[2]);
+
+    int driver;
+    ASSERT_EQ(run_tag_query(&world, &tags, freecs_mask_or(BIT_POSITION, BIT_HEALTH), FREECS_MASK_EMPTY, FREECS_TAG_BIT(tag_frozen), 0, &driver), 29);
+    ASSERT_EQ(driver, tag_frozen);
+    ASSERT_EQ(run_tag_query(&world, &tags, BIT_POSITION, FREECS_MASK_EMPTY, FREECS_TAG_BIT(tag_burning), FREECS_TAG_BIT(tag_frozen), &driver), 2998 - 59);
+    ASSERT_EQ(driver, tag_burning);
+    ASSERT_EQ(run_tag_query(&world, &tags, BIT_POSITION, BIT_HEALTH, FREECS_TAG_BIT(tag_burning) | FREECS_TAG_BIT(tag_frozen), 0, &driver), 30);
+    ASSERT_EQ(driver, tag_frozen);
+    ASSERT_EQ(run_tag_query(&world, &tags, BIT_POSITION, FREECS_MASK_EMPTY, 0, FREECS_TAG_BIT(tag_burning), &driver), 3000);
+    ASSERT_EQ(driver, -1);
+
+    freecs_entity_t* fresh = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), 10, &count_b);
+    for (size_t i = 0; i < 10; i++) {
+        FREECS_SET(&world, fresh[i], Position, BIT_POSITION, ((Position){(float)fresh[i].id, 0.0f}));
+    }
+    for (size_t i = 1; i < 40; i += 2) {
+        freecs_add_tag(&tags, tag_burning, a[i]);
+    }
+    ASSERT_EQ(run_tag_query(&world, &tags, freecs_mask_or(BIT_POSITION, BIT_HEALTH), FREECS_MASK_EMPTY, FREECS_TAG_BIT(tag_burning), 0, &driver), 1499);
+    ASSERT_EQ(driver, -1);
+
+    free(fresh);
+    free(a);
+    free(b);
+    freecs_destroy_tags(&tags);
+    freecs_destroy_world(&world);
+}
+
 TEST(matching_archetypes_and_columns) {
     freecs_world_t world = freecs_create_world();
     setup_world(&world);
@@ -416,23 +851,28 @@ TEST(matching_archetypes_and_columns) {
 
     freecs_spawn(&world, BIT_POSITION, e1, 1);
     freecs_spawn(&world, BIT_POSITION, e2, 1);
-    freecs_spawn(&world, BIT_POSITION | BIT_VELOCITY, e3, 2);
+    freecs_spawn(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), e3, 2);
 
     size_t matching_count;
-    size_t* matching = freecs_get_matching_archetypes(&world, BIT_POSITION, 0, &matching_count);
+    size_t* matching = freecs_get_matching_archetypes(&world, BIT_POSITION, FREECS_MASK_EMPTY, &matching_count);
 
     ASSERT(matching_count > 0);
 
     size_t total_entities = 0;
     for (size_t i = 0; i < matching_count; i++) {
         freecs_archetype_t* arch = &world.archetypes[matching[i]];
+#ifndef FREECS_CHUNKED_STORAGE
         Position* positions = freecs_column_unchecked(arch, BIT_POSITION);
-
         ASSERT(positions != NULL);
+#endif
 
         for (size_t j = 0; j < arch->entities_len; j++) {
+            Position* position = freecs_column_row(arch, BIT_POSITION, j);
+#ifndef FREECS_CHUNKED_STORAGE
+            ASSERT(position == &positions[j]);
+#endif
             total_entities++;
-            ASSERT(positions[j].x >= 1.0f && positions[j].x <= 5.0f);
+            ASSERT(position->x >= 1.0f && position->x <= 5.0f);
         }
     }
 
@@ -470,6 +910,1018 @@ TEST(queue_despawn) {
     freecs_destroy_world(&world);
 }
 
+TEST(despawn_batch) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t count_a, count_b;
+    freecs_entity_t* a = freecs_spawn_batch(&world, BIT_POSITION, 1000, &count_a);
+    freecs_entity_t* b = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), 500, &count_b);
+    for (size_t i = 0; i < count_a; i++) {
+        FREECS_SET(&world, a[i], Position, BIT_POSITION, ((Position){(float)i, 0.0f}));
+    }
+    for (size_t i = 0; i < count_b; i++) {
+        FREECS_SET(&world, b[i], Health, BIT_HEALTH, ((Health){(float)i}));
+    }
+
+    freecs_entity_t victims[1200];
+    size_t victims_len = 0;
+    for (size_t i = 0; i < count_a; i += 3) victims[victims_len++] = a[i];
+    for (size_t i = count_b; i-- > 0;) {
+        if (i % 2 == 0) victims[victims_len++] = b[i];
+    }
+    victims[victims_len++] = a[0];
+    victims[victims_len++] = (freecs_entity_t){a[1].id, a[1].generation + 1};
+    victims[victims_len++] = (freecs_entity_t){999999, 0};
+
+    ASSERT_EQ(freecs_despawn_batch(&world, victims, victims_len), 334 + 250);
+    ASSERT_EQ(freecs_entity_count(&world), 1500 - 334 - 250);
+    ASSERT_EQ(world.free_entities_len, 334 + 250);
+
+    for (size_t i = 0; i < count_a; i++) {
+        ASSERT_EQ(freecs_is_alive(&world, a[i]), i % 3 != 0);
+        if (i % 3 != 0) {
+            ASSERT_FLOAT_EQ(FREECS_GET(&world, a[i], Position, BIT_POSITION)->x, (float)i);
+        }
+    }
+    for (size_t i = 0; i < count_b; i++) {
+        ASSERT_EQ(freecs_is_alive(&world, b[i]), i % 2 != 0);
+        if (i % 2 != 0) {
+            ASSERT_FLOAT_EQ(FREECS_GET(&world, b[i], Health, BIT_HEALTH)->value, (float)i);
+        }
+    }
+
+    ASSERT_EQ(freecs_despawn_batch(&world, victims, victims_len), 0);
+
+    free(a);
+    free(b);
+    freecs_destroy_world(&world);
+}
+
+static freecs_mask_t mask_from_bits(const freecs_mask_t* bits, size_t value) {
+    freecs_mask_t mask = FREECS_MASK_EMPTY;
+    for (size_t i = 0; value != 0; i++, value >>= 1) {
+        if (value & 1) mask = freecs_mask_or(mask, bits[i]);
+    }
+    return mask;
+}
+
+TEST(many_archetypes) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t bits[12];
+    for (size_t i = 0; i < 12; i++) {
+        bits[i] = freecs_register_component(&world, sizeof(uint32_t));
+    }
+
+    const size_t archetype_count = 2000;
+    freecs_entity_t* spawned = malloc(archetype_count * sizeof(freecs_entity_t));
+    for (size_t i = 0; i < archetype_count; i++) {
+        size_t count;
+        freecs_entity_t* entities = freecs_spawn_batch(&world, mask_from_bits(bits, i + 1), 1, &count);
+        ASSERT_EQ(count, 1);
+        spawned[i] = entities[0];
+        free(entities);
+    }
+
+    ASSERT_EQ(world.archetypes_len, archetype_count);
+    ASSERT_EQ(world.archetype_index_len, archetype_count);
+
+    for (size_t i = 0; i < archetype_count; i++) {
+        size_t count;
+        freecs_entity_t* entities = freecs_spawn_batch(&world, mask_from_bits(bits, i + 1), 1, &count);
+        free(entities);
+
+        bool ok;
+        ASSERT(freecs_mask_equal(freecs_component_mask(&world, spawned[i], &ok), mask_from_bits(bits, i + 1)));
+        ASSERT(ok);
+    }
+    ASSERT_EQ(world.archetypes_len, archetype_count);
+
+    size_t expected = 0;
+    for (size_t i = 0; i < archetype_count; i++) {
+        if (((i + 1) & 8) != 0) expected += 2;
+    }
+    ASSERT_EQ(freecs_query_count(&world, bits[3], FREECS_MASK_EMPTY), expected);
+    ASSERT_EQ(freecs_query_count(&world, bits[3], FREECS_MASK_EMPTY), expected);
+
+    free(spawned);
+    freecs_destroy_world(&world);
+}
+
+TEST(query_cache_high_bits) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t bits[FREECS_MAX_COMPONENTS];
+    for (size_t i = 0; i < FREECS_MAX_COMPONENTS; i++) {
+        bits[i] = freecs_register_component(&world, sizeof(uint32_t));
+    }
+
+    size_t count;
+    free(freecs_spawn_batch(&world, bits[0], 3, &count));
+    free(freecs_spawn_batch(&world, bits[32], 5, &count));
+
+    ASSERT_EQ(freecs_query_count(&world, bits[32], FREECS_MASK_EMPTY), 5);
+    ASSERT_EQ(freecs_query_count(&world, FREECS_MASK_EMPTY, bits[0]), 5);
+    ASSERT_EQ(freecs_query_count(&world, FREECS_MASK_EMPTY, bits[32]), 3);
+    ASSERT_EQ(freecs_query_count(&world, bits[63], FREECS_MASK_EMPTY), 0);
+
+    ASSERT_EQ(freecs_query_count(&world, bits[0], bits[40]), 3);
+    free(freecs_spawn_batch(&world, freecs_mask_or(bits[0], bits[40]), 7, &count));
+    ASSERT_EQ(freecs_query_count(&world, bits[0], bits[40]), 3);
+    ASSERT_EQ(freecs_query_count(&world, bits[0], FREECS_MASK_EMPTY), 10);
+
+    free(freecs_spawn_batch(&world, freecs_mask_or(bits[32], bits[63]), 2, &count));
+    ASSERT_EQ(freecs_query_count(&world, bits[63], FREECS_MASK_EMPTY), 2);
+    ASSERT_EQ(freecs_query_count(&world, FREECS_MASK_EMPTY, bits[0]), 7);
+
+    freecs_destroy_world(&world);
+}
+
+#if FREECS_MAX_COMPONENTS > 64
+#define WIDE_COMPONENTS (FREECS_MAX_COMPONENTS < 180 ? FREECS_MAX_COMPONENTS : 180)
+#define WIDE_LAST (WIDE_COMPONENTS - 1)
+#define WIDE_MID (WIDE_COMPONENTS - 30)
+
+TEST(wide_masks) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t bits[WIDE_COMPONENTS];
+    for (size_t i = 0; i < WIDE_COMPONENTS; i++) {
+        bits[i] = freecs_register_component(&world, sizeof(uint32_t));
+        ASSERT_EQ(freecs_bit_index(bits[i]), i);
+    }
+
+    uint32_t low = 7;
+    uint32_t high = WIDE_LAST;
+    freecs_type_info_entry_t entries[2] = {
+        {bits[0], sizeof(uint32_t), &low, 0},
+        {bits[WIDE_LAST], sizeof(uint32_t), &high, WIDE_LAST}
+    };
+    freecs_entity_t entity = freecs_spawn(&world, freecs_mask_or(bits[0], bits[WIDE_LAST]), entries, 2);
+
+    ASSERT(freecs_has(&world, entity, bits[WIDE_LAST]));
+    ASSERT(!freecs_has(&world, entity, bits[64]));
+    ASSERT(freecs_mask_is_empty(freecs_register_component(&world, sizeof(uint32_t))) == (WIDE_COMPONENTS == FREECS_MAX_COMPONENTS));
+    ASSERT_EQ(*(uint32_t*)freecs_get(&world, entity, bits[WIDE_LAST]), WIDE_LAST);
+
+    uint32_t mid = WIDE_MID;
+    freecs_add_component(&world, entity, bits[WIDE_MID], &mid, sizeof(uint32_t));
+    ASSERT(freecs_has_components(&world, entity, freecs_mask_or(freecs_mask_or(bits[0], bits[WIDE_MID]), bits[WIDE_LAST])));
+    ASSERT_EQ(*(uint32_t*)freecs_get(&world, entity, bits[WIDE_MID]), WIDE_MID);
+    ASSERT_EQ(*(uint32_t*)freecs_get(&world, entity, bits[0]), 7);
+
+    size_t count;
+    free(freecs_spawn_batch(&world, bits[WIDE_MID], 4, &count));
+    ASSERT_EQ(freecs_query_count(&world, bits[WIDE_MID], FREECS_MASK_EMPTY), 5);
+    ASSERT_EQ(freecs_query_count(&world, bits[WIDE_MID], bits[WIDE_LAST]), 4);
+    ASSERT_EQ(freecs_query_count(&world, bits[WIDE_LAST], FREECS_MASK_EMPTY), 1);
+
+    freecs_remove_component(&world, entity, bits[WIDE_LAST]);
+    ASSERT_EQ(freecs_query_count(&world, bits[WIDE_MID], bits[WIDE_LAST]), 5);
+    ASSERT_EQ(freecs_query_count(&world, bits[WIDE_LAST], FREECS_MASK_EMPTY), 0);
+
+    freecs_destroy_world(&world);
+}
+#endif
+
+TEST(sparse_edges) {
+    freecs_world_t world = freecs_create_world();
+    freecs_mask_t bits[10];
+    for (size_t i = 0; i < 10; i++) {
+        bits[i] = freecs_register_component(&world, sizeof(uint32_t));
+    }
+
+    uint32_t base = 1;
+    freecs_type_info_entry_t e[1] = {{bits[0], sizeof(uint32_t), &base, 0}};
+    freecs_entity_t entity = freecs_spawn(&world, bits[0], e, 1);
+
+    for (int round = 0; round < 2; round++) {
+        for (size_t i = 1; i < 10; i++) {
+            uint32_t value = (uint32_t)(i * 10);
+            ASSERT(freecs_add_component(&world, entity, bits[i], &value, sizeof(uint32_t)));
+            ASSERT_EQ(*(uint32_t*)freecs_get(&world, entity, bits[i]), i * 10);
+            ASSERT_EQ(*(uint32_t*)freecs_get(&world, entity, bits[0]), 1);
+            ASSERT(freecs_remove_component(&world, entity, bits[i]));
+            ASSERT(!freecs_has(&world, entity, bits[i]));
+        }
+    }
+
+    ASSERT_EQ(world.archetypes_len, 10);
+    freecs_archetype_t* base_arch = &world.archetypes[0];
+    ASSERT_EQ(base_arch->edges.inline_len, FREECS_INLINE_EDGES);
+    ASSERT_EQ(base_arch->edges.overflow_len, 9 - FREECS_INLINE_EDGES);
+    for (size_t i = 1; i < 10; i++) {
+        freecs_archetype_t* arch = &world.archetypes[i];
+        ASSERT(freecs_mask_equal(arch->mask, freecs_mask_or(bits[0], bits[i])));
+        ASSERT_EQ(arch->edges.inline_len, 1);
+        ASSERT_EQ(arch->edges.overflow_len, 0);
+    }
+
+    freecs_destroy_world(&world);
+}
+
+TEST(table_iterator_spans) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), 5000, &count);
+    ASSERT_EQ(count, 5000);
+    for (size_t i = 0; i < count; i++) {
+        FREECS_SET(&world, entities[i], Position, BIT_POSITION, ((Position){(float)entities[i].id, 0.0f}));
+    }
+    for (size_t i = 0; i < count; i += 3) {
+        ASSERT(freecs_despawn(&world, entities[i]));
+    }
+
+    size_t visited = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        Position* positions = FREECS_ITER_COLUMN(&result, Position, BIT_POSITION);
+        Velocity* velocities = FREECS_ITER_COLUMN(&result, Velocity, BIT_VELOCITY);
+        ASSERT(positions != NULL && velocities != NULL);
+#ifdef FREECS_CHUNKED_STORAGE
+        ASSERT(result.row_count <= result.archetype->chunk_rows);
+        ASSERT_EQ((uintptr_t)positions % FREECS_CHUNK_ALIGN, 0);
+        ASSERT_EQ((uintptr_t)velocities % FREECS_CHUNK_ALIGN, 0);
+#endif
+        for (size_t i = 0; i < result.row_count; i++) {
+            freecs_entity_t entity = result.archetype->entities[result.row_start + i];
+            ASSERT_FLOAT_EQ(positions[i].x, (float)entity.id);
+            ASSERT(freecs_column_row(result.archetype, BIT_POSITION, result.row_start + i) == &positions[i]);
+        }
+        visited += result.row_count;
+    }
+    ASSERT_EQ(visited, freecs_query_count(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), FREECS_MASK_EMPTY));
+
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
+#ifdef FREECS_CHUNKED_STORAGE
+TEST(chunked_pointer_stability) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    Position pos = {7.0f, 8.0f};
+    freecs_type_info_entry_t e[1] = {{BIT_POSITION, sizeof(Position), &pos, freecs_bit_index(BIT_POSITION)}};
+    freecs_entity_t first = freecs_spawn(&world, BIT_POSITION, e, 1);
+    Position* first_pos = FREECS_GET(&world, first, Position, BIT_POSITION);
+
+    for (int i = 0; i < 20000; i++) {
+        freecs_spawn(&world, BIT_POSITION, e, 1);
+    }
+
+    ASSERT(FREECS_GET(&world, first, Position, BIT_POSITION) == first_pos);
+    ASSERT_FLOAT_EQ(first_pos->x, 7.0f);
+    ASSERT_FLOAT_EQ(first_pos->y, 8.0f);
+
+    freecs_archetype_t* arch = &world.archetypes[world.locations[first.id].archetype_index];
+    ASSERT(arch->chunks_len > 1);
+    ASSERT_EQ(arch->chunk_bytes, FREECS_CHUNK_SIZE);
+
+    freecs_destroy_world(&world);
+}
+#endif
+
+TEST(aligned_components) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    freecs_mask_t BIT_WIDE = FREECS_REGISTER_ALIGNED(&world, Position, 64);
+    freecs_mask_t BIT_VEC = FREECS_REGISTER_ALIGNED(&world, Velocity, 32);
+
+    ASSERT(!freecs_mask_is_empty(BIT_WIDE));
+    ASSERT(freecs_mask_is_empty(freecs_register_component_aligned(&world, sizeof(float), 24)));
+
+    Position pos = {1.0f, 2.0f};
+    freecs_type_info_entry_t e[1] = {{BIT_POSITION, sizeof(Position), &pos, freecs_bit_index(BIT_POSITION)}};
+    freecs_entity_t entities[300];
+    for (size_t i = 0; i < 300; i++) {
+        entities[i] = freecs_spawn(&world, BIT_POSITION, e, 1);
+        Position wide = {(float)i, 0.0f};
+        ASSERT(freecs_add_component(&world, entities[i], BIT_WIDE, &wide, sizeof(Position)));
+        ASSERT(freecs_add_component(&world, entities[i], BIT_VEC, &wide, sizeof(Velocity)));
+    }
+
+    freecs_table_iterator_t iter = freecs_table_iterator(&world, freecs_mask_or(BIT_WIDE, BIT_VEC), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t result;
+    while (freecs_table_iterator_next(&iter, &result)) {
+        ASSERT_EQ((uintptr_t)freecs_iter_column(&result, BIT_WIDE) % 64, 0);
+        ASSERT_EQ((uintptr_t)freecs_iter_column(&result, BIT_VEC) % 32, 0);
+#ifndef FREECS_CHUNKED_STORAGE
+        ASSERT_EQ((uintptr_t)freecs_column_unchecked(result.archetype, BIT_WIDE) % 64, 0);
+#endif
+    }
+
+    for (size_t i = 0; i < 300; i++) {
+        ASSERT_FLOAT_EQ(FREECS_GET(&world, entities[i], Position, BIT_WIDE)->x, (float)i);
+        ASSERT_FLOAT_EQ(FREECS_GET(&world, entities[i], Position, BIT_POSITION)->y, 2.0f);
+    }
+
+    freecs_destroy_world(&world);
+}
+
+typedef struct {
+    freecs_mask_t position;
+    freecs_mask_t velocity;
+    _Atomic size_t rows;
+} ParContext;
+
+static void par_integrate(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    ParContext* ctx = user;
+    Position* positions = FREECS_ITER_COLUMN(view, Position, ctx->position);
+    Velocity* velocities = FREECS_ITER_COLUMN(view, Velocity, ctx->velocity);
+    ASSERT(view->row_count <= FREECS_PAR_BATCH_ROWS);
+    ASSERT(thread_index < 4);
+    for (size_t i = 0; i < view->row_count; i++) {
+        positions[i].x += velocities[i].x;
+    }
+    ctx->rows += view->row_count;
+}
+
+static void par_row(freecs_archetype_t* arch, size_t row, size_t thread_index, void* user) {
+    ParContext* ctx = user;
+    (void)thread_index;
+    Position* position = freecs_column_row(arch, ctx->position, row);
+    position->y += 1.0f;
+    ctx->rows++;
+}
+
+TEST(par_for_each_table) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t sizes[3] = {50000, 7, 9000};
+    freecs_mask_t masks[3] = {freecs_mask_or(BIT_POSITION, BIT_VELOCITY), freecs_mask_or(freecs_mask_or(BIT_POSITION, BIT_VELOCITY), BIT_HEALTH), freecs_mask_or(BIT_POSITION, BIT_VELOCITY)};
+    freecs_entity_t* spawned[3];
+    for (size_t a = 0; a < 3; a++) {
+        size_t count;
+        spawned[a] = freecs_spawn_batch(&world, masks[a], sizes[a], &count);
+        for (size_t i = 0; i < count; i++) {
+            FREECS_SET(&world, spawned[a][i], Velocity, BIT_VELOCITY, ((Velocity){1.0f, 0.0f}));
+        }
+    }
+
+    size_t thread_counts[2] = {1, 4};
+    for (size_t t = 0; t < 2; t++) {
+        freecs_thread_pool_t* pool = freecs_create_thread_pool(thread_counts[t]);
+        ASSERT_EQ(freecs_thread_pool_size(pool), thread_counts[t]);
+
+        ParContext ctx = {BIT_POSITION, BIT_VELOCITY, 0};
+        freecs_par_for_each_table(pool, &world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), FREECS_MASK_EMPTY, par_integrate, &ctx);
+        ASSERT_EQ(ctx.rows, 59007);
+
+        ctx.rows = 0;
+        freecs_par_for_each(pool, &world, BIT_POSITION, BIT_HEALTH, par_row, &ctx);
+        ASSERT_EQ(ctx.rows, 59000);
+
+        freecs_destroy_thread_pool(pool);
+    }
+
+    for (size_t a = 0; a < 3; a++) {
+        for (size_t i = 0; i < sizes[a]; i++) {
+            Position* position = FREECS_GET(&world, spawned[a][i], Position, BIT_POSITION);
+            ASSERT_FLOAT_EQ(position->x, 2.0f);
+            ASSERT_FLOAT_EQ(position->y, a == 1 ? 0.0f : 2.0f);
+        }
+        free(spawned[a]);
+    }
+
+    freecs_destroy_world(&world);
+}
+
+typedef struct {
+    freecs_mask_t spawn_mask;
+    freecs_mask_t count_mask;
+    _Atomic size_t runs;
+    size_t seen;
+} SystemState;
+
+static void spawner_system(freecs_world_t* world, freecs_command_buffer_t* commands, void* user) {
+    (void)world;
+    SystemState* state = user;
+    Position pos = {1.0f, 1.0f};
+    freecs_type_info_entry_t e[1] = {{state->spawn_mask, sizeof(Position), &pos, freecs_bit_index(state->spawn_mask)}};
+    freecs_queue_spawn(commands, state->spawn_mask, e, 1);
+    state->runs++;
+}
+
+static void counter_system(freecs_world_t* world, freecs_command_buffer_t* commands, void* user) {
+    (void)commands;
+    SystemState* state = user;
+    state->seen = freecs_query_count(world, state->count_mask, FREECS_MASK_EMPTY);
+    state->runs++;
+}
+
+TEST(scheduler) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    freecs_thread_pool_t* pool = freecs_create_thread_pool(4);
+    freecs_scheduler_t scheduler = freecs_create_scheduler(&world, pool);
+
+    SystemState spawn_state = {BIT_POSITION, FREECS_MASK_EMPTY, 0, 0};
+    SystemState count_state = {FREECS_MASK_EMPTY, BIT_POSITION, 0, 0};
+    SystemState velocity_state = {FREECS_MASK_EMPTY, BIT_VELOCITY, 0, 0};
+    SystemState health_state = {BIT_HEALTH, FREECS_MASK_EMPTY, 0, 0};
+    SystemState final_state = {FREECS_MASK_EMPTY, BIT_HEALTH, 0, 0};
+
+    size_t spawner = freecs_add_system(&scheduler, "spawner", spawner_system, FREECS_MASK_EMPTY, BIT_POSITION, &spawn_state);
+    size_t counter = freecs_add_system(&scheduler, "counter", counter_system, BIT_POSITION, FREECS_MASK_EMPTY, &count_state);
+    size_t velocity = freecs_add_system(&scheduler, "velocity", counter_system, BIT_VELOCITY, FREECS_MASK_EMPTY, &velocity_state);
+    size_t health = freecs_add_system(&scheduler, "health", spawner_system, FREECS_MASK_EMPTY, BIT_HEALTH, &health_state);
+    freecs_add_sync_point(&scheduler);
+    size_t final = freecs_add_system(&scheduler, "final", counter_system, BIT_HEALTH, FREECS_MASK_EMPTY, &final_state);
+
+    for (int frame = 0; frame < 3; frame++) {
+        freecs_run_schedule(&scheduler);
+        ASSERT_EQ(count_state.seen, (size_t)frame + 1);
+        ASSERT_EQ(final_state.seen, (size_t)frame + 1);
+    }
+
+    ASSERT_EQ(scheduler.systems[spawner].level, 0);
+    ASSERT_EQ(scheduler.systems[counter].level, 1);
+    ASSERT_EQ(scheduler.systems[velocity].level, 0);
+    ASSERT_EQ(scheduler.systems[health].level, 0);
+    ASSERT_EQ(scheduler.systems[final].level, 2);
+    ASSERT_EQ(scheduler.levels_len, 3);
+    ASSERT_EQ(spawn_state.runs, 3);
+    ASSERT_EQ(velocity_state.runs, 3);
+    ASSERT_EQ(freecs_entity_count(&world), 6);
+
+    freecs_destroy_scheduler(&scheduler);
+    freecs_destroy_thread_pool(pool);
+    freecs_destroy_world(&world);
+}
+
+TEST(command_add_remove_components) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    freecs_entity_t entities[1000];
+    for (size_t i = 0; i < 1000; i++) {
+        Position pos = {(float)i, 0.0f};
+        freecs_type_info_entry_t e[1] = {{BIT_POSITION, sizeof(Position), &pos, freecs_bit_index(BIT_POSITION)}};
+        entities[i] = freecs_spawn(&world, BIT_POSITION, e, 1);
+    }
+    freecs_entity_t stale = entities[999];
+    freecs_despawn(&world, stale);
+
+    freecs_command_buffer_t buffer = freecs_create_command_buffer(&world);
+    for (size_t i = 0; i < 999; i++) {
+        if (i % 2 == 0) {
+            Velocity vel = {(float)i, (float)i};
+            freecs_type_info_entry_t e[1] = {{BIT_VELOCITY, sizeof(Velocity), &vel, freecs_bit_index(BIT_VELOCITY)}};
+            freecs_queue_add_components_with_data(&buffer, entities[i], BIT_VELOCITY, e, 1);
+        }
+        if (i % 3 == 0) {
+            freecs_queue_remove_components(&buffer, entities[i], BIT_POSITION);
+        }
+        if (i % 5 == 0) {
+            Health health = {(float)i};
+            freecs_type_info_entry_t e[1] = {{BIT_HEALTH, sizeof(Health), &health, freecs_bit_index(BIT_HEALTH)}};
+            freecs_queue_add_components(&buffer, entities[i], BIT_HEALTH);
+            freecs_queue_remove_components(&buffer, entities[i], BIT_HEALTH);
+            freecs_queue_add_components_with_data(&buffer, entities[i], BIT_HEALTH, e, 1);
+        }
+    }
+    freecs_queue_add_components(&buffer, entities[7], BIT_VELOCITY);
+    freecs_queue_remove_components(&buffer, entities[7], BIT_VELOCITY);
+    freecs_queue_remove_components(&buffer, entities[11], BIT_POSITION);
+    freecs_queue_add_components(&buffer, entities[11], BIT_POSITION);
+    freecs_queue_add_components(&buffer, entities[13], freecs_mask_or(BIT_POSITION, BIT_VELOCITY));
+    freecs_queue_add_components(&buffer, stale, BIT_VELOCITY);
+
+    Position spawned_pos = {-1.0f, -1.0f};
+    freecs_type_info_entry_t spawn_entries[1] = {{BIT_POSITION, sizeof(Position), &spawned_pos, freecs_bit_index(BIT_POSITION)}};
+    freecs_queue_spawn(&buffer, BIT_POSITION, spawn_entries, 1);
+    freecs_queue_remove_components(&buffer, entities[1], BIT_POSITION);
+
+    freecs_apply_commands(&buffer);
+    ASSERT_EQ(buffer.commands_len, 0);
+    ASSERT(!freecs_is_alive(&world, stale));
+
+    for (size_t i = 0; i < 999; i++) {
+        freecs_entity_t entity = entities[i];
+        bool has_position = i % 3 != 0 && i != 1;
+        bool has_velocity = i % 2 == 0 || i == 13;
+        bool has_health = i % 5 == 0;
+        if (!has_position && !has_velocity && !has_health) {
+            ASSERT(!freecs_is_alive(&world, entity));
+            continue;
+        }
+        ASSERT(freecs_is_alive(&world, entity));
+        ASSERT_EQ(freecs_has(&world, entity, BIT_POSITION), has_position);
+        ASSERT_EQ(freecs_has(&world, entity, BIT_VELOCITY), has_velocity);
+        ASSERT_EQ(freecs_has(&world, entity, BIT_HEALTH), has_health);
+        if (has_position) {
+            ASSERT_FLOAT_EQ(FREECS_GET(&world, entity, Position, BIT_POSITION)->x, i == 11 ? 0.0f : (float)i);
+        }
+        if (has_velocity) {
+            ASSERT_FLOAT_EQ(FREECS_GET(&world, entity, Velocity, BIT_VELOCITY)->y, i == 13 ? 0.0f : (float)i);
+        }
+        if (has_health) {
+            ASSERT_FLOAT_EQ(FREECS_GET(&world, entity, Health, BIT_HEALTH)->value, (float)i);
+        }
+    }
+
+    size_t position_only = 0;
+    for (size_t i = 0; i < 999; i++) {
+        if (i % 3 != 0 && i != 1 && i != 13 && i % 2 != 0 && i % 5 != 0) position_only++;
+    }
+    ASSERT_EQ(freecs_query_count(&world, BIT_POSITION, freecs_mask_or(BIT_VELOCITY, BIT_HEALTH)), position_only + 1);
+
+    freecs_destroy_command_buffer(&buffer);
+    freecs_destroy_world(&world);
+}
+
+TEST(command_buffer_arena) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    freecs_command_buffer_t buffer = freecs_create_command_buffer(&world);
+    for (int round = 0; round < 3; round++) {
+        for (int i = 0; i < 1000; i++) {
+            Position pos = {(float)i, (float)round};
+            Health health = {(float)(i * 2)};
+            freecs_type_info_entry_t e[2] = {
+                {BIT_POSITION, sizeof(Position), &pos, freecs_bit_index(BIT_POSITION)},
+                {BIT_HEALTH, sizeof(Health), &health, freecs_bit_index(BIT_HEALTH)}
+            };
+            freecs_queue_spawn(&buffer, freecs_mask_or(BIT_POSITION, BIT_HEALTH), e, 2);
+        }
+        ASSERT_EQ(buffer.commands_len, 1000);
+        ASSERT(buffer.arena_len > 1000 * (sizeof(Position) + sizeof(Health)));
+
+        uint8_t* arena = buffer.arena;
+        size_t arena_cap = buffer.arena_cap;
+        freecs_apply_commands(&buffer);
+        ASSERT_EQ(buffer.commands_len, 0);
+        ASSERT_EQ(buffer.arena_len, 0);
+        ASSERT(buffer.arena == arena);
+        ASSERT_EQ(buffer.arena_cap, arena_cap);
+    }
+
+    size_t count;
+    freecs_entity_t* entities = freecs_query_entities(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), FREECS_MASK_EMPTY, &count);
+    ASSERT_EQ(count, 3000);
+    for (size_t i = 0; i < count; i++) {
+        Position* pos = FREECS_GET(&world, entities[i], Position, BIT_POSITION);
+        Health* health = FREECS_GET(&world, entities[i], Health, BIT_HEALTH);
+        ASSERT_FLOAT_EQ(health->value, pos->x * 2.0f);
+    }
+    free(entities);
+
+    freecs_destroy_command_buffer(&buffer);
+    freecs_destroy_world(&world);
+}
+
+typedef struct {
+    freecs_thread_commands_t* commands;
+    freecs_mask_t position;
+    freecs_mask_t health;
+} ThreadCommandContext;
+
+static void record_thread_commands(const freecs_table_iterator_result_t* view, size_t thread_index, void* user) {
+    ThreadCommandContext* ctx = user;
+    freecs_command_buffer_t* buffer = freecs_thread_commands_begin(ctx->commands, thread_index, (uint64_t)view->index << 32 | view->row_start);
+    Position* positions = FREECS_ITER_COLUMN(view, Position, ctx->position);
+    freecs_entity_t* entities = &view->archetype->entities[view->row_start];
+    for (size_t i = 0; i < view->row_count; i++) {
+        if ((int)positions[i].x % 3 == 0) {
+            freecs_cmd_queue_despawn(buffer, entities[i]);
+        } else {
+            Health health = {positions[i].x};
+            freecs_type_info_entry_t e[1] = {{ctx->health, sizeof(Health), &health, freecs_bit_index(ctx->health)}};
+            freecs_queue_spawn(buffer, ctx->health, e, 1);
+        }
+    }
+}
+
+TEST(thread_command_buffers) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 20000, &count);
+    for (size_t i = 0; i < count; i++) {
+        FREECS_SET(&world, entities[i], Position, BIT_POSITION, ((Position){(float)i, 0.0f}));
+    }
+    free(entities);
+
+    freecs_thread_pool_t* pool = freecs_create_thread_pool(4);
+    freecs_thread_commands_t commands = freecs_create_thread_commands(&world, freecs_thread_pool_size(pool));
+    ThreadCommandContext ctx = {&commands, BIT_POSITION, BIT_HEALTH};
+
+    freecs_command_buffer_t first = freecs_create_command_buffer(&world);
+    freecs_command_buffer_t second = freecs_create_command_buffer(&world);
+    freecs_par_for_each_table(pool, &world, BIT_POSITION, FREECS_MASK_EMPTY, record_thread_commands, &ctx);
+    freecs_merge_thread_commands(&commands, &first);
+    freecs_par_for_each_table(pool, &world, BIT_POSITION, FREECS_MASK_EMPTY, record_thread_commands, &ctx);
+    freecs_merge_thread_commands(&commands, &second);
+
+    ASSERT_EQ(first.commands_len, 20000);
+    ASSERT_EQ(second.commands_len, first.commands_len);
+    for (size_t i = 0; i < first.commands_len; i++) {
+        ASSERT_EQ(first.commands[i].command_type, second.commands[i].command_type);
+        ASSERT_EQ(first.commands[i].entity.id, second.commands[i].entity.id);
+        if (first.commands[i].command_type == FREECS_CMD_SPAWN) {
+            const freecs_command_component_t* a = (const freecs_command_component_t*)(first.arena + first.commands[i].components_offset);
+            const freecs_command_component_t* b = (const freecs_command_component_t*)(second.arena + second.commands[i].components_offset);
+            ASSERT_FLOAT_EQ(((Health*)(first.arena + a->data_offset))->value, ((Health*)(second.arena + b->data_offset))->value);
+        }
+    }
+    ASSERT_EQ(first.commands[0].command_type, FREECS_CMD_DESPAWN);
+    ASSERT_EQ(first.commands[0].entity.id, 0);
+
+    freecs_clear_command_buffer(&second);
+    freecs_par_for_each_table(pool, &world, BIT_POSITION, FREECS_MASK_EMPTY, record_thread_commands, &ctx);
+    freecs_apply_thread_commands(&commands);
+    ASSERT_EQ(freecs_query_count(&world, BIT_POSITION, FREECS_MASK_EMPTY), 13333);
+    ASSERT_EQ(freecs_query_count(&world, BIT_HEALTH, FREECS_MASK_EMPTY), 13333);
+
+    freecs_destroy_command_buffer(&first);
+    freecs_destroy_command_buffer(&second);
+    freecs_destroy_thread_commands(&commands);
+    freecs_destroy_thread_pool(pool);
+    freecs_destroy_world(&world);
+}
+
+static size_t spatial_distances(freecs_world_t* world, float x, float y, float* out) {
+    size_t total = 0;
+    freecs_table_iterator_t iter = freecs_table_iterator(world, BIT_POSITION, FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t view;
+    while (freecs_table_iterator_next(&iter, &view)) {
+        Position* positions = FREECS_ITER_COLUMN(&view, Position, BIT_POSITION);
+        for (size_t i = 0; i < view.row_count; i++) {
+            float dx = positions[i].x - x, dy = positions[i].y - y;
+            out[total++] = dx * dx + dy * dy;
+        }
+    }
+    return total;
+}
+
+static size_t brute_radius(freecs_world_t* world, float x, float y, float radius) {
+    static float distances[8192];
+    size_t total = spatial_distances(world, x, y, distances);
+    size_t found = 0;
+    for (size_t i = 0; i < total; i++) {
+        if (distances[i] <= radius * radius) found++;
+    }
+    return found;
+}
+
+static int compare_floats(const void* a, const void* b) {
+    float fa = *(const float*)a;
+    float fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+static int check_spatial(freecs_world_t* world, freecs_spatial_index_t* index) {
+    static freecs_entity_t hits[4096];
+    static float distances[8192];
+    const float probes[4][3] = {{0.0f, 0.0f, 7.5f}, {-40.0f, 31.0f, 12.0f}, {49.0f, -49.0f, 3.0f}, {10.0f, 10.0f, 200.0f}};
+
+    for (size_t p = 0; p < 4; p++) {
+        float x = probes[p][0], y = probes[p][1], radius = probes[p][2];
+        size_t found = freecs_spatial_query_radius(index, x, y, radius, hits, 4096);
+        if (found != brute_radius(world, x, y, radius)) return 0;
+        for (size_t i = 0; i < found && i < 4096; i++) {
+            if (!freecs_is_alive(world, hits[i])) return 0;
+            Position* pos = FREECS_GET(world, hits[i], Position, BIT_POSITION);
+            float dx = pos->x - x, dy = pos->y - y;
+            if (dx * dx + dy * dy > radius * radius) return 0;
+        }
+
+        size_t total = spatial_distances(world, x, y, distances);
+        qsort(distances, total, sizeof(float), compare_floats);
+
+        size_t nearest = freecs_spatial_query_nearest(index, x, y, 16, 0.0f, hits);
+        if (nearest != (total < 16 ? total : 16)) return 0;
+        for (size_t i = 0; i < nearest; i++) {
+            Position* pos = FREECS_GET(world, hits[i], Position, BIT_POSITION);
+            float dx = pos->x - x, dy = pos->y - y;
+            if (dx * dx + dy * dy != distances[i]) return 0;
+        }
+
+        size_t bounded = freecs_spatial_query_nearest(index, x, y, 4096, radius, hits);
+        if (bounded != brute_radius(world, x, y, radius)) return 0;
+    }
+    return 1;
+}
+
+TEST(spatial_index) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    srand(7);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 3000, &count);
+    free(freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), 1000, &count));
+    free(freecs_spawn_batch(&world, BIT_HEALTH, 100, &count));
+
+    freecs_table_iterator_t iter = freecs_table_iterator(&world, BIT_POSITION, FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t view;
+    while (freecs_table_iterator_next(&iter, &view)) {
+        Position* positions = FREECS_ITER_COLUMN(&view, Position, BIT_POSITION);
+        for (size_t i = 0; i < view.row_count; i++) {
+            positions[i] = (Position){(float)rand() / RAND_MAX * 100.0f - 50.0f, (float)rand() / RAND_MAX * 100.0f - 50.0f};
+        }
+    }
+
+    freecs_spatial_index_t index = freecs_create_spatial_index(&world, BIT_POSITION, 4.0f, 256);
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(index.count, 4000);
+    ASSERT(check_spatial(&world, &index));
+
+    for (size_t i = 0; i < 3000; i += 2) {
+        Position* pos = FREECS_GET(&world, entities[i], Position, BIT_POSITION);
+        pos->x = -pos->x + 0.5f;
+        pos->y *= 0.25f;
+    }
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(index.count, 4000);
+    ASSERT(check_spatial(&world, &index));
+
+    freecs_entity_t victims[1000];
+    for (size_t i = 0; i < 1000; i++) victims[i] = entities[i * 3];
+    ASSERT_EQ(freecs_despawn_batch(&world, victims, 1000), 1000);
+    freecs_entity_t* reborn = freecs_spawn_batch(&world, BIT_POSITION, 500, &count);
+    for (size_t i = 0; i < count; i++) {
+        FREECS_SET(&world, reborn[i], Position, BIT_POSITION, ((Position){(float)i * 0.1f - 25.0f, 3.0f}));
+    }
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(index.count, 3500);
+    ASSERT(check_spatial(&world, &index));
+
+    ASSERT_EQ(freecs_spatial_query_radius(&index, 0.0f, 0.0f, 1e30f, NULL, 0), 3500);
+    ASSERT_EQ(freecs_spatial_query_radius(&index, 0.0f, 0.0f, 3e9f, NULL, 0), 3500);
+    ASSERT_EQ(freecs_spatial_query_radius(&index, 1e12f, -1e12f, 2.0f, NULL, 0), 0);
+
+    freecs_entity_t one;
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, -25.0f, 3.0f, 1, 1.0f, &one), 1);
+    ASSERT_EQ(one.id, reborn[0].id);
+    ASSERT_EQ(one.generation, reborn[0].generation);
+
+    free(entities);
+    free(reborn);
+    freecs_destroy_spatial_index(&index);
+    freecs_destroy_world(&world);
+}
+
+TEST(spatial_nearest_sparse) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, BIT_POSITION, 3, &count);
+    freecs_entity_t near = entities[0], far = entities[1], edge = entities[2];
+    FREECS_SET(&world, near, Position, BIT_POSITION, ((Position){0.0f, 0.0f}));
+    FREECS_SET(&world, far, Position, BIT_POSITION, ((Position){20000.0f, 0.0f}));
+    FREECS_SET(&world, edge, Position, BIT_POSITION, ((Position){3e9f, -3e9f}));
+
+    freecs_spatial_index_t index = freecs_create_spatial_index(&world, BIT_POSITION, 1.0f, 64);
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(index.count, 3);
+
+    freecs_entity_t hits[3];
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, 0.0f, 0.0f, 2, 0.0f, hits), 2);
+    ASSERT_EQ(hits[0].id, near.id);
+    ASSERT_EQ(hits[1].id, far.id);
+
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, 19990.0f, 5.0f, 3, 0.0f, hits), 3);
+    ASSERT_EQ(hits[0].id, far.id);
+    ASSERT_EQ(hits[1].id, near.id);
+    ASSERT_EQ(hits[2].id, edge.id);
+
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, 3e9f, -3e9f, 1, 0.0f, hits), 1);
+    ASSERT_EQ(hits[0].id, edge.id);
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, 1e12f, 1e12f, 1, 0.0f, hits), 1);
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, 10000.0f, 0.0f, 3, 100.0f, hits), 0);
+    ASSERT_EQ(freecs_spatial_query_nearest(&index, 10.0f, 0.0f, 3, 20000.0f, hits), 2);
+    ASSERT_EQ(hits[0].id, near.id);
+
+    free(entities);
+    freecs_destroy_spatial_index(&index);
+    freecs_destroy_world(&world);
+}
+
+static size_t collect_changed(freecs_world_t* world, freecs_mask_t mask, uint32_t since_tick, uint8_t* seen) {
+    size_t rows = 0;
+    freecs_table_iterator_t iter = freecs_query_changed(world, mask, since_tick);
+    freecs_table_iterator_result_t view;
+    while (freecs_table_iterator_next(&iter, &view)) {
+        for (size_t i = 0; i < view.row_count; i++) {
+            seen[view.archetype->entities[view.row_start + i].id]++;
+        }
+        rows += view.row_count;
+    }
+    return rows;
+}
+
+TEST(change_detection) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    freecs_track_changes(&world, BIT_POSITION);
+
+    size_t count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_VELOCITY), 5000, &count);
+    static uint8_t seen[8192];
+
+    memset(seen, 0, sizeof(seen));
+    ASSERT_EQ(collect_changed(&world, BIT_POSITION, freecs_change_tick(&world), seen), 5000);
+
+    uint32_t since = freecs_advance_tick(&world);
+    ASSERT_EQ(collect_changed(&world, BIT_POSITION, since, seen), 0);
+    ASSERT_EQ(collect_changed(&world, BIT_VELOCITY, since, seen), 0);
+    ASSERT_EQ(collect_changed(&world, BIT_VELOCITY, 0, seen), 0);
+
+    FREECS_GET(&world, entities[10], Position, BIT_POSITION)->x = 1.0f;
+    FREECS_GET_MUT(&world, entities[20], Position, BIT_POSITION)->x = 2.0f;
+    FREECS_SET(&world, entities[4000], Position, BIT_POSITION, ((Position){3.0f, 0.0f}));
+    freecs_mark_changed(&world, entities[4999], BIT_POSITION);
+    FREECS_GET_MUT(&world, entities[30], Velocity, BIT_VELOCITY)->x = 1.0f;
+
+    memset(seen, 0, sizeof(seen));
+    ASSERT_EQ(collect_changed(&world, BIT_POSITION, since, seen), 3);
+    ASSERT(seen[entities[20].id] && seen[entities[4000].id] && seen[entities[4999].id]);
+    ASSERT(freecs_changed_since(&world, entities[20], BIT_POSITION, since));
+    ASSERT(!freecs_changed_since(&world, entities[10], BIT_POSITION, since));
+    ASSERT(!freecs_changed_since(&world, entities[30], BIT_VELOCITY, since));
+    ASSERT_EQ(collect_changed(&world, BIT_VELOCITY, since, seen), 0);
+
+    freecs_despawn(&world, entities[0]);
+    freecs_despawn(&world, entities[20]);
+    FREECS_ADD(&world, entities[4000], Health, BIT_HEALTH, ((Health){5.0f}));
+    FREECS_ADD(&world, entities[100], Health, BIT_HEALTH, ((Health){5.0f}));
+    freecs_remove_component(&world, entities[200], BIT_VELOCITY);
+
+    memset(seen, 0, sizeof(seen));
+    ASSERT_EQ(collect_changed(&world, BIT_POSITION, since, seen), 2);
+    ASSERT(seen[entities[4000].id] && seen[entities[4999].id]);
+
+    freecs_command_buffer_t commands = freecs_create_command_buffer(&world);
+    Position moved = {9.0f, 9.0f};
+    freecs_type_info_entry_t entry = {BIT_POSITION, sizeof(Position), &moved, freecs_bit_index(BIT_POSITION)};
+    freecs_queue_add_components_with_data(&commands, entities[300], BIT_POSITION, &entry, 1);
+    freecs_queue_add_components_with_data(&commands, entities[400], freecs_mask_or(BIT_POSITION, BIT_HEALTH), &entry, 1);
+    freecs_queue_remove_components(&commands, entities[500], BIT_VELOCITY);
+    freecs_apply_commands(&commands);
+    freecs_destroy_command_buffer(&commands);
+
+    memset(seen, 0, sizeof(seen));
+    ASSERT_EQ(collect_changed(&world, BIT_POSITION, since, seen), 4);
+    ASSERT(seen[entities[300].id] && seen[entities[400].id]);
+    ASSERT(!seen[entities[500].id]);
+
+    since = freecs_advance_tick(&world);
+    freecs_table_iterator_t iter = freecs_table_iterator(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), FREECS_MASK_EMPTY);
+    freecs_table_iterator_result_t view;
+    size_t touched = 0;
+    while (freecs_table_iterator_next(&iter, &view)) {
+        Position* positions = FREECS_ITER_COLUMN_MUT(&world, &view, Position, BIT_POSITION);
+        positions[0].y += 1.0f;
+        touched += view.row_count;
+    }
+    memset(seen, 0, sizeof(seen));
+    ASSERT_EQ(collect_changed(&world, BIT_POSITION, since, seen), touched);
+    ASSERT_EQ(touched, 3);
+
+    freecs_spatial_index_t index = freecs_create_spatial_index(&world, BIT_POSITION, 8.0f, 64);
+    uint32_t tick = freecs_change_tick(&world);
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(freecs_change_tick(&world), tick);
+    ASSERT_EQ(index.count, 4998);
+
+    uint32_t spatial_since = freecs_advance_tick(&world);
+    FREECS_GET_MUT(&world, entities[50], Position, BIT_POSITION)->x = 500.0f;
+    freecs_despawn(&world, entities[60]);
+    freecs_spatial_update(&index, spatial_since);
+    ASSERT_EQ(freecs_change_tick(&world), spatial_since);
+    ASSERT_EQ(index.count, 4997);
+    freecs_entity_t hit;
+    ASSERT_EQ(freecs_spatial_query_radius(&index, 500.0f, 0.0f, 1.0f, &hit, 1), 1);
+    ASSERT_EQ(hit.id, entities[50].id);
+
+    spatial_since = freecs_advance_tick(&world);
+    FREECS_GET(&world, entities[51], Position, BIT_POSITION)->x = 700.0f;
+    freecs_spatial_update(&index, spatial_since);
+    ASSERT_EQ(freecs_spatial_query_radius(&index, 700.0f, 0.0f, 1.0f, &hit, 1), 0);
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(freecs_spatial_query_radius(&index, 700.0f, 0.0f, 1.0f, &hit, 1), 1);
+    ASSERT_EQ(hit.id, entities[51].id);
+
+    size_t spawned;
+    freecs_entity_t* unindexed = freecs_spawn_batch(&world, BIT_POSITION, 1, &spawned);
+    spatial_since = freecs_advance_tick(&world);
+    freecs_despawn(&world, entities[61]);
+    ASSERT_EQ(freecs_query_count(&world, BIT_POSITION, FREECS_MASK_EMPTY), index.count);
+    freecs_spatial_update(&index, spatial_since);
+    ASSERT_EQ(index.count, 4996);
+    ASSERT_EQ(index.slots[entities[61].id].bucket, UINT32_MAX);
+
+    freecs_remove_component(&world, entities[62], BIT_POSITION);
+    freecs_spatial_update(&index, spatial_since);
+    ASSERT_EQ(index.count, 4995);
+    ASSERT_EQ(index.slots[entities[62].id].bucket, UINT32_MAX);
+
+    freecs_despawn(&world, entities[63]);
+    freecs_clear_component_events(&world);
+    freecs_despawn(&world, entities[64]);
+    freecs_spatial_update(&index, spatial_since);
+    ASSERT_EQ(index.count, 4993);
+    ASSERT_EQ(index.slots[entities[63].id].bucket, UINT32_MAX);
+    ASSERT_EQ(index.slots[entities[64].id].bucket, UINT32_MAX);
+
+    freecs_spatial_update(&index, 0);
+    ASSERT_EQ(index.count, 4994);
+    ASSERT(index.slots[unindexed[0].id].bucket != UINT32_MAX);
+
+    free(unindexed);
+    freecs_destroy_spatial_index(&index);
+    free(entities);
+    freecs_destroy_world(&world);
+}
+
+static bool stream_contains(const freecs_entity_t* stream, size_t count, freecs_entity_t entity) {
+    for (size_t i = 0; i < count; i++) {
+        if (stream[i].id == entity.id && stream[i].generation == entity.generation) return true;
+    }
+    return false;
+}
+
+TEST(component_events) {
+    freecs_world_t world = freecs_create_world();
+    setup_world(&world);
+    freecs_observe_components(&world, freecs_mask_or(BIT_HEALTH, BIT_VELOCITY));
+
+    size_t count, added_count, removed_count;
+    freecs_entity_t* entities = freecs_spawn_batch(&world, freecs_mask_or(BIT_POSITION, BIT_HEALTH), 10, &count);
+    freecs_entity_t* plain = freecs_spawn_batch(&world, BIT_POSITION, 10, &count);
+
+    const freecs_entity_t* added = freecs_added(&world, BIT_HEALTH, &added_count);
+    ASSERT_EQ(added_count, 10);
+    ASSERT(stream_contains(added, added_count, entities[9]));
+    freecs_added(&world, BIT_POSITION, &added_count);
+    ASSERT_EQ(added_count, 0);
+
+    freecs_clear_component_events(&world);
+    freecs_added(&world, BIT_HEALTH, &added_count);
+    ASSERT_EQ(added_count, 0);
+
+    FREECS_ADD(&world, plain[0], Health, BIT_HEALTH, ((Health){1.0f}));
+    FREECS_ADD(&world, plain[1], Velocity, BIT_VELOCITY, ((Velocity){1.0f, 0.0f}));
+    FREECS_ADD(&world, entities[0], Health, BIT_HEALTH, ((Health){2.0f}));
+    freecs_remove_component(&world, entities[1], BIT_HEALTH);
+    freecs_despawn(&world, entities[2]);
+    freecs_entity_t batch[2] = {entities[3], plain[2]};
+    freecs_despawn_batch(&world, batch, 2);
+    Health hp = {3.0f};
+    freecs_type_info_entry_t entry = {BIT_HEALTH, sizeof(Health), &hp, freecs_bit_index(BIT_HEALTH)};
+    freecs_entity_t spawned = freecs_spawn(&world, BIT_HEALTH, &entry, 1);
+
+    freecs_command_buffer_t commands = freecs_create_command_buffer(&world);
+    freecs_queue_add_components(&commands, plain[3], BIT_HEALTH);
+    freecs_queue_remove_components(&commands, entities[4], BIT_HEALTH);
+    freecs_queue_add_components(&commands, entities[5], BIT_VELOCITY);
+    freecs_queue_remove_components(&commands, entities[6], freecs_mask_or(BIT_POSITION, BIT_HEALTH));
+    freecs_apply_commands(&commands);
+    freecs_destroy_command_buffer(&commands);
+
+    added = freecs_added(&world, BIT_HEALTH, &added_count);
+    ASSERT_EQ(added_count, 3);
+    ASSERT(stream_contains(added, added_count, plain[0]));
+    ASSERT(stream_contains(added, added_count, spawned));
+    ASSERT(stream_contains(added, added_count, plain[3]));
+
+    const freecs_entity_t* removed = freecs_removed(&world, BIT_HEALTH, &removed_count);
+    ASSERT_EQ(removed_count, 5);
+    ASSERT(stream_contains(removed, removed_count, entities[1]));
+    ASSERT(stream_contains(removed, removed_count, entities[2]));
+    ASSERT(stream_contains(removed, removed_count, entities[3]));
+    ASSERT(stream_contains(removed, removed_count, entities[4]));
+    ASSERT(stream_contains(removed, removed_count, entities[6]));
+    ASSERT(!freecs_is_alive(&world, entities[6]));
+
+    added = freecs_added(&world, BIT_VELOCITY, &added_count);
+    ASSERT_EQ(added_count, 2);
+    freecs_removed(&world, BIT_VELOCITY, &removed_count);
+    ASSERT_EQ(removed_count, 0);
+
+    freecs_despawn(&world, plain[0]);
+    size_t filtered_count;
+    freecs_entity_t* filtered = freecs_query_added(&world, BIT_HEALTH, BIT_POSITION, FREECS_MASK_EMPTY, &filtered_count);
+    ASSERT_EQ(filtered_count, 1);
+    ASSERT_EQ(filtered[0].id, plain[3].id);
+    free(filtered);
+
+    freecs_clear_component_events(&world);
+    freecs_removed(&world, BIT_HEALTH, &removed_count);
+    ASSERT_EQ(removed_count, 0);
+
+    free(entities);
+    free(plain);
+    freecs_destroy_world(&world);
+}
+
 int main(void) {
     printf("Running freecs tests...\n\n");
     fflush(stdout);
@@ -479,15 +1931,44 @@ int main(void) {
     RUN_TEST(set_component);
     RUN_TEST(despawn_entity);
     RUN_TEST(generational_indices);
+    RUN_TEST(dead_slots_reject_next_generation);
     RUN_TEST(multiple_archetypes);
     RUN_TEST(query_count);
     RUN_TEST(add_component);
     RUN_TEST(remove_component);
     RUN_TEST(spawn_batch);
+    RUN_TEST(spawn_batch_columns);
+    RUN_TEST(entity_range_allocation);
     RUN_TEST(event_queue);
+    RUN_TEST(event_readers);
+    RUN_TEST(par_send_events);
     RUN_TEST(tags);
+    RUN_TEST(tags_sparse_set);
+    RUN_TEST(tags_despawn_cleanup);
+    RUN_TEST(tag_queries);
     RUN_TEST(matching_archetypes_and_columns);
     RUN_TEST(queue_despawn);
+    RUN_TEST(despawn_batch);
+    RUN_TEST(many_archetypes);
+    RUN_TEST(query_cache_high_bits);
+    RUN_TEST(sparse_edges);
+    RUN_TEST(table_iterator_spans);
+    RUN_TEST(aligned_components);
+    RUN_TEST(par_for_each_table);
+    RUN_TEST(scheduler);
+    RUN_TEST(command_add_remove_components);
+    RUN_TEST(command_buffer_arena);
+    RUN_TEST(thread_command_buffers);
+    RUN_TEST(spatial_index);
+    RUN_TEST(spatial_nearest_sparse);
+    RUN_TEST(change_detection);
+    RUN_TEST(component_events);
+#ifdef FREECS_CHUNKED_STORAGE
+    RUN_TEST(chunked_pointer_stability);
+#endif
+#if FREECS_MAX_COMPONENTS > 64
+    RUN_TEST(wide_masks);
+#endif
 
     printf("\n%d/%d tests passed\n", tests_passed, tests_run);
 